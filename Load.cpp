@@ -1,6 +1,7 @@
-#include <fstream>
-#include <sstream>
+#include "geotable.h"
+
 #include <vector>
+#include <algorithm>
 
 #include <fantom/algorithm.hpp>
 #include <fantom/fields.hpp>
@@ -28,6 +29,8 @@ namespace
             Options(Algorithm::Options::Control& control) : DataAlgorithm::Options(control)
             {
                 add<InputLoadPath>("Input File", "The file to be read", "");
+                add<int>("Parser threads", "Threads used to parse the file, 0 uses all cores", 0);
+                add<bool>("Log stations", "Log every station that is read", false);
             }
         };
 
@@ -55,49 +58,45 @@ namespace
             // Test, ob die Dati gesetzt ist, sonst nichts machen
             if (parameters.get<std::string>("Input File") != "")
             {
-                std::ifstream infile(parameters.get<std::string>("Input File"));
+                cGeoTableParser oParser;
+                sGeoTable oTable;
 
                 // Fehler werfen, wenn die Datei ungueltig ist
-                if (!infile)
+                if (!oParser.LoadFromFile(parameters.get<std::string>("Input File"), oTable,
+                                          static_cast<unsigned>(std::max(0, parameters.get<int>("Parser threads")))))
                 {
                     throw "Input file cannot be opened";
                 }
 
-                std::string line;
-
-                // skip first two lines
-                getline(infile, line);
-                getline(infile, line);
-
                 // Speicher fuer die Daten
                 std::vector<Point2> positions;
                 std::vector<Scalar> temperatures;
                 std::vector<Scalar> rainfalls;
                 std::vector<Scalar> sunshines;
+                positions.reserve(oTable.Size());
+                temperatures.reserve(oTable.Size());
+                rainfalls.reserve(oTable.Size());
+                sunshines.reserve(oTable.Size());
 
-                // Schleife zum einlesen der Daten
-                int i = 0;
-
-                while (getline(infile, line))
+                bool bLogStations = parameters.get<bool>("Log stations");
+                for (std::size_t i=0; i<oTable.Size(); ++i)
                 {
-                    std::stringstream str(line);
-                    double lat;
-                    double lon;
-                    double temperatur;
-                    double rainfall;
-                    double sunshine;
-                    str >> lat;
-                    str >> lon;
-                    str >> temperatur;
-                    str >> rainfall;
-                    str >> sunshine;
-                    positions.push_back(Point2(lat, lon));
-                    temperatures.push_back(Scalar(temperatur));
-                    rainfalls.push_back(Scalar(rainfall));
-                    sunshines.push_back(Scalar(sunshine));
-                    infoLog() << "Point" << i++ << " (" << lat << ", " << lon << ")\n";
+                    positions.push_back(Point2(oTable.vecLatitude[i], oTable.vecLongitude[i]));
+                    temperatures.push_back(Scalar(oTable.vecTemperature[i]));
+                    rainfalls.push_back(Scalar(oTable.vecRainfall[i]));
+                    sunshines.push_back(Scalar(oTable.vecSunshine[i]));
+                    if (bLogStations)
+                    {
+                        infoLog() << "Point" << i << " (" << oTable.vecLatitude[i] << ", " << oTable.vecLongitude[i] << ")\n";
+                    }
                 }
 
+                // eine Zeile statt einer pro Station
+                double fSeconds = (oParser.Seconds() > 0.0) ? oParser.Seconds() : 1e-9;
+                infoLog() << oTable.Size() << " stations, " << oParser.Bytes() / 1e6 << " MB in "
+                          << fSeconds * 1e3 << " ms (" << oTable.Size() / fSeconds << " rows/s, "
+                          << oParser.Bytes() / 1e6 / fSeconds << " MB/s)" << std::endl;
+
                 auto domain = DomainFactory::makeDomainArbitrary(positions);
                 auto fieldTemperature  = DomainFactory::makeTensorField(*domain, temperatures);
                 auto fieldRainfall  = DomainFactory::makeTensorField(*domain, rainfalls);
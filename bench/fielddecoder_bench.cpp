@@ -0,0 +1,238 @@
+/* Compares the stringstream based number conversion the skeleton loader
+ * used before with the batch decoder from fielddecoder.h. Before timing,
+ * ParseFloat is checked bit for bit against strtof on random decimals and
+ * on values next to float midpoints, ParseInt64 on the int64 limits.
+ *
+ * Build (from this directory):
+ *   g++ -O2 -std=c++11 -I.. fielddecoder_bench.cpp ../fielddecoder.cpp \
+ *       ../csvreader.cpp ../mappedfile.cpp -o fielddecoder_bench
+ * Run:
+ *   ./fielddecoder_bench ../Motion1_160714_2207.csv [repetitions]
+ */
+#include "fielddecoder.h"
+#include "csvreader.h"
+#include "mappedfile.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    // the helpers from helper.cpp before the batch decoder
+    float StreamSToF(const std::string& sStrIn)
+    {
+        float fF = 0.0f;
+        std::stringstream sStrOut(sStrIn);
+        sStrOut >> fF;
+        return fF;
+    }
+
+
+    std::int64_t StreamSToLL(const std::string& sStrIn)
+    {
+        std::int64_t nLL = 0;
+        std::stringstream sStrOut(sStrIn);
+        sStrOut >> nLL;
+        return nLL;
+    }
+
+
+    bool SameFloat(const char* sText)
+    {
+        float fExpected = strtof(sText, NULL);
+        float fValue;
+        ParseFloat(sText, sText + strlen(sText), fValue);
+        if (memcmp(&fExpected, &fValue, sizeof(float)) != 0)
+        {
+            std::cerr << "ParseFloat(" << sText << ") differs from strtof" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+
+    // returns the number of inputs on which ParseFloat and strtof disagree
+    std::size_t CheckParseFloat(std::size_t nValues)
+    {
+        std::mt19937_64 oRandom(42);
+        std::size_t nMismatches = 0;
+        char aText[64];
+        for (std::size_t i=0; i<nValues; ++i)
+        {
+            // decimals as a recording has them, with any digit count and exponent
+            std::uint64_t nMantissa = oRandom() % 10000000000000000000ull;
+            nMantissa /= static_cast<std::uint64_t>(std::pow(10.0, static_cast<double>(oRandom() % 19)));
+            int nExponent = static_cast<int>(oRandom() % 90) - 55;
+            snprintf(aText, sizeof(aText), "%s%" PRIu64 "e%d", (oRandom() & 1) ? "-" : "", nMantissa, nExponent);
+            nMismatches += SameFloat(aText) ? 0 : 1;
+
+            // halfway between two floats the double rounding would go wrong
+            std::uint32_t nBits = static_cast<std::uint32_t>(oRandom() % 0x7f000000u) + 0x00800000u;
+            float fLow, fHigh;
+            memcpy(&fLow, &nBits, sizeof(float));
+            ++nBits;
+            memcpy(&fHigh, &nBits, sizeof(float));
+            double fMidpoint = (static_cast<double>(fLow) + static_cast<double>(fHigh)) / 2.0;
+            for (int nDigits : {9, 17, 25, 40})
+            {
+                snprintf(aText, sizeof(aText), "%.*g", nDigits, fMidpoint);
+                nMismatches += SameFloat(aText) ? 0 : 1;
+            }
+        }
+        return nMismatches;
+    }
+
+
+    std::size_t CheckParseInt64()
+    {
+        struct sCase
+        {
+            const char* sText;
+            std::int64_t nExpected;
+        };
+        const sCase aCases[] = {
+            {"9223372036854775807", INT64_MAX},
+            {"9223372036854775808", INT64_MAX},
+            {"123456789012345678901234", INT64_MAX},
+            {"-9223372036854775808", INT64_MIN},
+            {"-9223372036854775809", INT64_MIN},
+            {"-99999999999999999999", INT64_MIN},
+            {"1476445862123", 1476445862123}
+        };
+        std::size_t nMismatches = 0;
+        for (const sCase& oCase : aCases)
+        {
+            std::int64_t nValue;
+            ParseInt64(oCase.sText, oCase.sText + strlen(oCase.sText), nValue);
+            if (nValue != oCase.nExpected)
+            {
+                std::cerr << "ParseInt64(" << oCase.sText << ") = " << nValue << std::endl;
+                ++nMismatches;
+            }
+        }
+        return nMismatches;
+    }
+
+
+    double Seconds(std::chrono::steady_clock::time_point oStart)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - oStart).count();
+    }
+
+
+    void Report(const char* sName, double fSeconds, std::size_t nRows, std::size_t nBytes, double fChecksum)
+    {
+        std::cout << sName << ": "
+                  << fSeconds * 1000.0 << " ms, "
+                  << nRows / fSeconds << " rows/s, "
+                  << nBytes / fSeconds / (1024.0 * 1024.0) << " MB/s"
+                  << " (checksum " << fChecksum << ")" << std::endl;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <recording.csv> [repetitions]" << std::endl;
+        return 1;
+    }
+
+    int nRepetitions = (argc > 2) ? atoi(argv[2]) : 50;
+
+    std::size_t nMismatches = CheckParseFloat(200000) + CheckParseInt64();
+    std::cout << "mismatches against strtof and the int64 limits: " << nMismatches << std::endl;
+    if (nMismatches > 0)
+    {
+        return 1;
+    }
+
+    cMappedFile oFile(argv[1]);
+    if (!oFile.IsOpen())
+    {
+        std::cerr << "can not open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::string sContent(oFile.Begin(), oFile.Size());
+    std::size_t nBytes = oFile.Size() * nRepetitions;
+
+    // getline + stringstream per row and per cell
+    {
+        std::size_t nRows = 0;
+        double fChecksum = 0.0;
+        auto oStart = std::chrono::steady_clock::now();
+        for (int r=0; r<nRepetitions; ++r)
+        {
+            std::istringstream oStream(sContent);
+            for (cCSVIterator oRow(oStream); oRow != cCSVIterator(); ++oRow)
+            {
+                if (oRow->size() == 0)
+                {
+                    continue;
+                }
+                fChecksum += static_cast<double>(StreamSToLL((*oRow)[0]) % 1000);
+                for (std::size_t i=1; i<oRow->size(); ++i)
+                {
+                    fChecksum += StreamSToF((*oRow)[i]);
+                }
+                ++nRows;
+            }
+        }
+        Report("cCSVRow + stringstream", Seconds(oStart), nRows, nBytes, fChecksum);
+    }
+
+    // one pass per row over the mapped bytes
+    {
+        std::size_t nRows = 0;
+        double fChecksum = 0.0;
+        std::vector<float> vecValues(256);
+        auto oStart = std::chrono::steady_clock::now();
+        for (int r=0; r<nRepetitions; ++r)
+        {
+            const char* pCur = oFile.Begin();
+            const char* pEnd = oFile.End();
+            while (pCur < pEnd)
+            {
+                const char* pLineEnd = FindDelimiter(pCur, pEnd, '\n');
+                const char* pNext = (pLineEnd < pEnd) ? pLineEnd + 1 : pEnd;
+                if (pLineEnd > pCur && *(pLineEnd - 1) == '\r')
+                {
+                    --pLineEnd;
+                }
+
+                const char* pTimeEnd = FindDelimiter(pCur, pLineEnd, '\t');
+                std::int64_t nTime;
+                ParseInt64(pCur, pTimeEnd, nTime);
+                fChecksum += static_cast<double>(nTime % 1000);
+
+                if (pTimeEnd < pLineEnd)
+                {
+                    std::size_t nValues = DecodeFloats(pTimeEnd + 1, pLineEnd, '\t',
+                                                       vecValues.data(), vecValues.size());
+                    for (std::size_t i=0; i<nValues; ++i)
+                    {
+                        fChecksum += vecValues[i];
+                    }
+                }
+
+                ++nRows;
+                pCur = pNext;
+            }
+        }
+        Report("DecodeFloats           ", Seconds(oStart), nRows, nBytes, fChecksum);
+    }
+
+    return 0;
+}
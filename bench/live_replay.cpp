@@ -0,0 +1,206 @@
+/* Stand-in for the live sensor: streams a skeleton recording over UDP to
+ * 127.0.0.1 at the speed it was recorded, as cLiveSkeleton packets or as
+ * rows in the recording layout. With "local" the receiver runs in the same
+ * process and the latency from sending a frame to it being part of the
+ * cHierarchicMotion is reported at the end.
+ *
+ * Build (from this directory):
+ *   g++ -O2 -std=c++11 -pthread -I.. live_replay.cpp ../fielddecoder.cpp ../framearena.cpp \
+ *       ../framefilter.cpp ../framering.cpp ../framevalidator.cpp ../helper.cpp \
+ *       ../hierarchicmotion.cpp ../joint.cpp ../liveskeleton.cpp ../mappedfile.cpp \
+ *       ../p2quantile.cpp ../skeletonframes.cpp ../skeletonparser.cpp ../skeletonschema.cpp \
+ *       ../validationstats.cpp -o live_replay
+ * Run:
+ *   ./live_replay ../Motion1_160714_2207.csv [port] [binary|text] [local] [ticks per second]
+ *
+ * Port 0 with "local" picks a free port. The timestamps of the Kinect
+ * recordings count 100 ns ticks, other recorders need the last argument.
+ */
+#include "fielddecoder.h"
+#include "framering.h"
+#include "liveskeleton.h"
+#include "mappedfile.h"
+#include "skeletonframes.h"
+#include "skeletonparser.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    struct sRow
+    {
+        std::int64_t nTime;
+        const char* pBegin;
+        const char* pEnd;
+    };
+
+
+    // the data rows of the recording with their timestamps, the header row goes to sHeader
+    std::vector<sRow> SplitRows(const cMappedFile& oFile, std::string& sHeader)
+    {
+        std::vector<sRow> vecRows;
+        const char* pLine = oFile.Begin();
+        while (pLine < oFile.End())
+        {
+            const char* pLineEnd = FindDelimiter(pLine, oFile.End(), '\n');
+            const char* pNext = (pLineEnd < oFile.End()) ? pLineEnd + 1 : oFile.End();
+            std::int64_t nTime = 0;
+            if (pLine < pLineEnd && (isdigit(static_cast<unsigned char>(*pLine)) || *pLine == '-'))
+            {
+                ParseInt64(pLine, pLineEnd, nTime);
+                vecRows.push_back({nTime, pLine, pNext});
+            }
+            else if (vecRows.empty() && pLine < pLineEnd)
+            {
+                sHeader.assign(pLine, pNext);
+            }
+            pLine = pNext;
+        }
+        return vecRows;
+    }
+
+
+    void Send(int nSocket, const sockaddr_in& oAddress, const void* pData, std::size_t nBytes)
+    {
+        sendto(nSocket, pData, nBytes, 0, reinterpret_cast<const sockaddr*>(&oAddress), sizeof(oAddress));
+    }
+
+
+    // frames without timestamp go out right away, all others when they are due
+    void Replay(const std::string& sFilename, unsigned short nPort, bool bText, double fTicksPerSecond)
+    {
+        cMappedFile oFile;
+        if (!oFile.Open(sFilename))
+        {
+            std::cerr << "cannot open " << sFilename << std::endl;
+            return;
+        }
+        std::string sHeader;
+        std::vector<sRow> vecRows = SplitRows(oFile, sHeader);
+
+        cSkeletonCSVParser oParser;
+        cSkeletonFrames oFrames;
+        if (!bText)
+        {
+            oParser.Parse(oFile.Begin(), oFile.End(), oFrames);
+        }
+
+        int nSocket = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in oAddress;
+        memset(&oAddress, 0, sizeof(oAddress));
+        oAddress.sin_family = AF_INET;
+        oAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        oAddress.sin_port = htons(nPort);
+
+        if (bText && !sHeader.empty())
+        {
+            Send(nSocket, oAddress, sHeader.data(), sHeader.size());
+        }
+
+        auto oStart = std::chrono::steady_clock::now();
+        std::int64_t nFirstTime = 0;
+        cLiveSkeleton::sPacket oPacket;
+        oPacket.nMagic = cLiveSkeleton::nPacketMagic;
+        oPacket.nReserved = 0;
+        for (std::size_t nRow=0; nRow<vecRows.size(); ++nRow)
+        {
+            std::int64_t nTime = vecRows[nRow].nTime;
+            if (nTime != 0)
+            {
+                nFirstTime = nFirstTime ? nFirstTime : nTime;
+                std::this_thread::sleep_until(oStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>((nTime - nFirstTime) / fTicksPerSecond)));
+            }
+
+            if (bText)
+            {
+                Send(nSocket, oAddress, vecRows[nRow].pBegin, vecRows[nRow].pEnd - vecRows[nRow].pBegin);
+            }
+            else if (nRow < oFrames.Size())
+            {
+                oPacket.nTime = oFrames.Time(nRow);
+                for (std::size_t nColumn=0; nColumn<cSkeletonFrames::nColumns; ++nColumn)
+                {
+                    oPacket.aPositions[nColumn] = oFrames.Column(nColumn)[nRow];
+                }
+                oPacket.nSent = cFrameRing::Now();
+                Send(nSocket, oAddress, &oPacket, sizeof(oPacket));
+            }
+        }
+        close(nSocket);
+
+        std::cout << vecRows.size() << " frames sent in " << std::fixed << std::setprecision(2)
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - oStart).count()
+                  << " s" << std::endl;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " recording [port] [binary|text] [local] [ticks per second]" << std::endl;
+        return 1;
+    }
+    std::string sFilename = argv[1];
+    unsigned short nPort = static_cast<unsigned short>((argc > 2) ? atoi(argv[2]) : 7425);
+    bool bText = (argc > 3) && std::string(argv[3]) == "text";
+    bool bLocal = (argc > 4) && std::string(argv[4]) == "local";
+    double fTicksPerSecond = (argc > 5) ? atof(argv[5]) : 1e7;
+
+    if (!bLocal)
+    {
+        Replay(sFilename, nPort, bText, fTicksPerSecond);
+        return 0;
+    }
+
+    cLiveSkeleton oLive;
+    if (!oLive.Start(nPort))
+    {
+        std::cerr << "cannot receive on port " << nPort << std::endl;
+        return 1;
+    }
+
+    std::atomic<bool> bDone(false);
+    std::thread oSender([&]()
+    {
+        Replay(sFilename, oLive.Port(), bText, fTicksPerSecond);
+        bDone = true;
+    });
+
+    // the main thread owns the motion, as the viewer would
+    while (!bDone)
+    {
+        oLive.Poll(0.1);
+    }
+    oSender.join();
+    // the last datagrams may still be on their way
+    while (oLive.Poll(0.2) > 0)
+    {
+    }
+    oLive.Stop();
+
+    std::cout << oLive.Received() << " received, " << oLive.Dropped() << " dropped, "
+              << oLive.Malformed() << " malformed, " << oLive.Motion()->Size() << " in the motion" << std::endl
+              << oLive.Motion()->Statistics().Summary() << std::endl
+              << "latency median " << std::setprecision(3) << oLive.LatencyMedian() * 1000.0
+              << " ms, 99% " << oLive.LatencyTail() * 1000.0
+              << " ms, max " << oLive.LatencyMax() * 1000.0 << " ms" << std::endl;
+    return 0;
+}
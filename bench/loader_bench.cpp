@@ -0,0 +1,584 @@
+/* Throughput, heap allocations and peak memory of the file loaders, outside
+ * of fantom. Synthetic skeleton recordings, GeoData tables and 16 bit depth
+ * PNGs with 1e3, 1e4, ... records (rows, stations, pixels) are generated once
+ * into the output directory and reused by later runs.
+ *
+ * Build (from this directory):
+ *   g++ -O2 -std=c++11 -pthread -I.. -DLODEPNG_NO_COMPILE_ALLOCATORS loader_bench.cpp \
+ *       ../compactmotion.cpp ../contactdetector.cpp ../csvreader.cpp ../fielddecoder.cpp ../framearena.cpp ../framefilter.cpp ../framevalidator.cpp \
+ *       ../geotable.cpp ../gzipreader.cpp ../helper.cpp ../hierarchicmotion.cpp ../joint.cpp \
+ *       ../jointindex.cpp ../kinectcsv.cpp ../kinematics.cpp ../lodepng.cpp ../mappedfile.cpp ../motionbatch.cpp ../motioncache.cpp \
+ *       ../p2quantile.cpp ../skeletonframes.cpp ../skeletonparser.cpp ../skeletonschema.cpp \
+ *       ../validationstats.cpp -o loader_bench
+ * Run:
+ *   ./loader_bench [output directory] [max records]
+ *
+ * allocs/heap count operator new and lodepng's allocator per run; peak heap
+ * is the highest amount of live heap memory during the run. Memory mapped
+ * input is not heap, it shows up in the process' max RSS only.
+ */
+#include "compactmotion.h"
+#include "contactdetector.h"
+#include "csvreader.h"
+#include "geotable.h"
+#include "helper.h"
+#include "joint.h"
+#include "jointindex.h"
+#include "kinectcsv.h"
+#include "lodepng.h"
+#include "motionbatch.h"
+#include "parallel.h"
+#include "skeletonframes.h"
+#include "skeletonparser.h"
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    std::atomic<std::size_t> g_nAllocations(0);
+    std::atomic<std::size_t> g_nAllocatedBytes(0);
+    std::atomic<std::size_t> g_nLiveBytes(0);
+    std::atomic<std::size_t> g_nPeakBytes(0);
+
+    // the block size is kept in front of every block, so frees can be counted
+    const std::size_t nHeaderSize = 16;
+
+    // keeps the compiler from dropping conversions whose results are not used
+    volatile double g_fSink = 0.0;
+
+
+    void* CountedMalloc(std::size_t nSize)
+    {
+        char* pBlock = static_cast<char*>(malloc(nSize + nHeaderSize));
+        if (!pBlock)
+        {
+            return NULL;
+        }
+        *reinterpret_cast<std::size_t*>(pBlock) = nSize;
+
+        ++g_nAllocations;
+        g_nAllocatedBytes += nSize;
+        std::size_t nLive = (g_nLiveBytes += nSize);
+        std::size_t nPeak = g_nPeakBytes.load();
+        while (nLive > nPeak && !g_nPeakBytes.compare_exchange_weak(nPeak, nLive))
+        {
+        }
+        return pBlock + nHeaderSize;
+    }
+
+
+    void CountedFree(void* pData)
+    {
+        if (!pData)
+        {
+            return;
+        }
+        char* pBlock = static_cast<char*>(pData) - nHeaderSize;
+        g_nLiveBytes -= *reinterpret_cast<std::size_t*>(pBlock);
+        free(pBlock);
+    }
+}
+
+
+void* operator new(std::size_t nSize)
+{
+    void* pData = CountedMalloc(nSize ? nSize : 1);
+    if (!pData)
+    {
+        throw std::bad_alloc();
+    }
+    return pData;
+}
+
+
+void* operator new[](std::size_t nSize)
+{
+    return operator new(nSize);
+}
+
+
+void operator delete(void* pData) noexcept
+{
+    CountedFree(pData);
+}
+
+
+void operator delete[](void* pData) noexcept
+{
+    CountedFree(pData);
+}
+
+
+// lodepng.cpp is built with LODEPNG_NO_COMPILE_ALLOCATORS and uses these
+void* lodepng_malloc(size_t nSize)
+{
+    return CountedMalloc(nSize);
+}
+
+
+void* lodepng_realloc(void* pData, size_t nNewSize)
+{
+    void* pNew = CountedMalloc(nNewSize);
+    if (pNew && pData)
+    {
+        std::size_t nOldSize = *reinterpret_cast<std::size_t*>(static_cast<char*>(pData) - nHeaderSize);
+        memcpy(pNew, pData, (nOldSize < nNewSize) ? nOldSize : nNewSize);
+        CountedFree(pData);
+    }
+    return pNew;
+}
+
+
+void lodepng_free(void* pData)
+{
+    CountedFree(pData);
+}
+
+
+namespace
+{
+    // one frame of Motion1_160714_2207.csv, the synthetic climber moves it around
+    const float aBasePose[JT_Count * 3] = {
+        0.124538f, -0.283232f, 2.81134f,   0.133318f, 0.0277205f, 2.85408f,
+        0.141297f, 0.330732f, 2.88331f,    0.0961755f, 0.46856f, 2.88078f,
+        -0.0077663f, 0.203618f, 2.97529f,  -0.0655004f, -0.084718f, 3.01549f,
+        -0.147437f, -0.302151f, 2.99845f,  -0.170463f, -0.33709f, 2.96738f,
+        0.275162f, 0.22374f, 2.81288f,     0.396644f, 0.00809588f, 2.74756f,
+        0.41828f, -0.209756f, 2.53778f,    0.406502f, -0.265549f, 2.49743f,
+        0.0583257f, -0.28393f, 2.78933f,   -0.104168f, -0.612575f, 2.67107f,
+        -0.271956f, -0.933904f, 2.58346f,  -0.321625f, -0.952846f, 2.45307f,
+        0.187428f, -0.274932f, 2.75791f,   0.297062f, -0.604067f, 2.67281f,
+        0.4205f, -0.980507f, 2.64173f,     0.361724f, -0.999233f, 2.51166f,
+        0.139438f, 0.25603f, 2.87843f,     -0.187433f, -0.383599f, 2.94798f,
+        -0.18487f, -0.360386f, 2.93917f,   0.408097f, -0.309343f, 2.46669f,
+        0.36586f, -0.264548f, 2.49353f
+    };
+
+
+    struct sResult
+    {
+        std::size_t nRecords;
+        double fSeconds;
+        std::size_t nAllocations;
+        std::size_t nAllocatedBytes;
+        std::size_t nPeakBytes;
+    };
+
+
+    bool FileExists(const std::string& sFilename)
+    {
+        struct stat oStat;
+        return stat(sFilename.c_str(), &oStat) == 0;
+    }
+
+
+    std::size_t FileSize(const std::string& sFilename)
+    {
+        struct stat oStat;
+        return (stat(sFilename.c_str(), &oStat) == 0) ? static_cast<std::size_t>(oStat.st_size) : 0;
+    }
+
+
+    double MaxRSSMegabytes()
+    {
+        struct rusage oUsage;
+        getrusage(RUSAGE_SELF, &oUsage);
+        return oUsage.ru_maxrss / 1024.0;
+    }
+
+
+    // rows of the recorder's layout: the pose drifts up the wall and jitters a little
+    void WriteSkeletonCSV(const std::string& sFilename, std::size_t nRows)
+    {
+        FILE* pFile = fopen(sFilename.c_str(), "wb");
+        if (!pFile)
+        {
+            throw fileNotFound();
+        }
+
+        fputs("Time", pFile);
+        for (int i=0; i<JT_Count; ++i)
+        {
+            const char* sName = JointTypeName(static_cast<eJointType>(i));
+            fprintf(pFile, "\t%s_X\t%s_Y\t%s_Z", sName, sName, sName);
+        }
+        fputs("\t\r\n", pFile);
+
+        std::mt19937 oRandom(1);
+        std::uniform_real_distribution<float> oJitter(-0.002f, 0.002f);
+        std::int64_t nTime = 2843650613099LL;
+        for (std::size_t nRow=0; nRow<nRows; ++nRow)
+        {
+            float fX = 0.2f * std::sin(nRow * 0.001f);
+            float fY = 0.5f * std::sin(nRow * 0.0003f);
+
+            fprintf(pFile, "%lld", static_cast<long long>(nTime));
+            for (int nColumn=0; nColumn<JT_Count * 3; ++nColumn)
+            {
+                float fOffset = (nColumn % 3 == 0) ? fX : (nColumn % 3 == 1) ? fY : 0.0f;
+                fprintf(pFile, "\t%g", aBasePose[nColumn] + fOffset + oJitter(oRandom));
+            }
+            fputs("\t\r\n", pFile);
+            nTime += 333333;
+        }
+        fclose(pFile);
+    }
+
+
+    void WriteGeoTable(const std::string& sFilename, std::size_t nRows)
+    {
+        FILE* pFile = fopen(sFilename.c_str(), "wb");
+        if (!pFile)
+        {
+            throw fileNotFound();
+        }
+
+        fputs("Lat Lon Temperatur Niederschlag Sonnenschein Ort\n\n", pFile);
+
+        std::mt19937 oRandom(2);
+        std::uniform_real_distribution<double> oLatitude(47.2, 55.1);
+        std::uniform_real_distribution<double> oLongitude(5.8, 15.1);
+        std::uniform_real_distribution<double> oTemperature(-2.0, 12.0);
+        std::uniform_real_distribution<double> oRainfall(0.0, 20.0);
+        std::uniform_real_distribution<double> oSunshine(10.0, 60.0);
+        for (std::size_t nRow=0; nRow<nRows; ++nRow)
+        {
+            fprintf(pFile, "%.7f %.7f %.1f %.1f %.1f Station%zu\n",
+                    oLatitude(oRandom), oLongitude(oRandom), oTemperature(oRandom),
+                    oRainfall(oRandom), oSunshine(oRandom), nRow);
+        }
+        fclose(pFile);
+    }
+
+
+    // a wall at about 2.5 m seen by the depth camera, with sensor noise
+    void WriteDepthPNG(const std::string& sFilename, std::size_t nPixels)
+    {
+        unsigned nWidth = static_cast<unsigned>(std::ceil(std::sqrt(static_cast<double>(nPixels))));
+        unsigned nHeight = static_cast<unsigned>((nPixels + nWidth - 1) / nWidth);
+
+        std::mt19937 oRandom(3);
+        std::uniform_int_distribution<int> oNoise(-4, 4);
+        std::vector<unsigned char> vecImage(static_cast<std::size_t>(nWidth) * nHeight * 2);
+        for (unsigned nRow=0; nRow<nHeight; ++nRow)
+        {
+            for (unsigned nCol=0; nCol<nWidth; ++nCol)
+            {
+                unsigned nDepth = 2500 + nRow / 4 + oNoise(oRandom);
+                std::size_t nIndex = (static_cast<std::size_t>(nRow) * nWidth + nCol) * 2;
+                vecImage[nIndex] = static_cast<unsigned char>(nDepth >> 8);
+                vecImage[nIndex + 1] = static_cast<unsigned char>(nDepth & 0xff);
+            }
+        }
+
+        unsigned nError = lodepng::encode(sFilename, vecImage, nWidth, nHeight, LCT_GREY, 16);
+        if (nError)
+        {
+            std::cerr << "encoder error " << nError << ": " << lodepng_error_text(nError) << std::endl;
+        }
+    }
+
+
+    // runs oLoader until at least fMinSeconds have passed, figures are per run
+    sResult Measure(const std::function<std::size_t()>& oLoader, double fMinSeconds = 0.2)
+    {
+        sResult oResult = {0, 0.0, 0, 0, 0};
+        std::size_t nRuns = 0;
+        double fTotal = 0.0;
+
+        do
+        {
+            std::size_t nAllocations = g_nAllocations;
+            std::size_t nAllocatedBytes = g_nAllocatedBytes;
+            std::size_t nLiveBefore = g_nLiveBytes;
+            g_nPeakBytes = nLiveBefore;
+
+            auto oStart = std::chrono::steady_clock::now();
+            oResult.nRecords = oLoader();
+            fTotal += std::chrono::duration<double>(std::chrono::steady_clock::now() - oStart).count();
+
+            oResult.nAllocations = g_nAllocations - nAllocations;
+            oResult.nAllocatedBytes = g_nAllocatedBytes - nAllocatedBytes;
+            oResult.nPeakBytes = g_nPeakBytes - nLiveBefore;
+            ++nRuns;
+        }
+        while (fTotal < fMinSeconds && nRuns < 1000);
+
+        oResult.fSeconds = fTotal / nRuns;
+        return oResult;
+    }
+
+
+    void Report(const std::string& sLoader, std::size_t nBytes, const sResult& oResult)
+    {
+        const double fMB = 1024.0 * 1024.0;
+        std::cout << std::left << std::setw(28) << sLoader << std::right
+                  << std::setw(10) << oResult.nRecords
+                  << std::setw(10) << std::fixed << std::setprecision(2) << nBytes / fMB
+                  << std::setw(11) << oResult.fSeconds * 1000.0
+                  << std::setw(13) << std::setprecision(0) << oResult.nRecords / oResult.fSeconds
+                  << std::setw(9) << std::setprecision(1) << nBytes / fMB / oResult.fSeconds
+                  << std::setw(11) << oResult.nAllocations
+                  << std::setw(10) << oResult.nAllocatedBytes / fMB
+                  << std::setw(10) << oResult.nPeakBytes / fMB
+                  << std::setw(10) << MaxRSSMegabytes()
+                  << std::endl;
+    }
+
+
+    void BenchSkeleton(const std::string& sDirectory, std::size_t nRecords)
+    {
+        std::string sFilename = sDirectory + "/skeleton_" + std::to_string(nRecords) + ".csv";
+        if (!FileExists(sFilename))
+        {
+            WriteSkeletonCSV(sFilename, nRecords);
+        }
+        std::size_t nBytes = FileSize(sFilename);
+
+        Report("cCSVRow + SToF", nBytes, Measure([&]
+        {
+            std::ifstream oStream(sFilename);
+            std::size_t nRows = 0;
+            double fChecksum = 0.0;
+            cCSVIterator oRow(oStream);
+            for (++oRow; oRow != cCSVIterator(); ++oRow)
+            {
+                for (std::size_t i=1; i<oRow->size(); ++i)
+                {
+                    fChecksum += SToF((*oRow)[i]);
+                }
+                ++nRows;
+            }
+            g_fSink = fChecksum;
+            return nRows;
+        }));
+
+        Report("cSkeletonCSVParser", nBytes, Measure([&]
+        {
+            cSkeletonCSVParser oParser;
+            cSkeletonFrames oFrames;
+            oParser.LoadFromFile(sFilename, oFrames);
+            return oFrames.Size();
+        }));
+
+        Report("cKinectCSV::LoadFromFile", nBytes, Measure([&]
+        {
+            cKinectCSV oKinect;
+            oKinect.LoadFromFile(sFilename);
+            return oKinect.GetJoints()[0].size();
+        }, 0.0));
+
+        // a session of eight recordings, sequentially and on all cores
+        std::vector<std::string> vecSession(8, sFilename);
+        std::vector<unsigned> vecThreadCounts(1, 1);
+        if (HardwareThreads() > 1)
+        {
+            vecThreadCounts.push_back(HardwareThreads());
+        }
+        for (unsigned nThreads : vecThreadCounts)
+        {
+            Report("cMotionBatch x8, " + std::to_string(nThreads) + " thr", nBytes * vecSession.size(), Measure([&]
+            {
+                cMotionBatch oBatch(nThreads);
+                oBatch.Load(vecSession);
+                return oBatch.Summary().nFrames;
+            }, 0.0));
+        }
+
+        // heap a library of the session keeps after loading, as float motions and quantized
+        {
+            std::size_t nBefore = g_nLiveBytes;
+            std::vector<std::unique_ptr<cKinectCSV>> vecFloat;
+            for (const std::string& sFile : vecSession)
+            {
+                vecFloat.emplace_back(new cKinectCSV());
+                vecFloat.back()->SetThreadCount(1);
+                vecFloat.back()->LoadFromFile(sFile);
+            }
+            std::size_t nFloatBytes = g_nLiveBytes - nBefore;
+            vecFloat.clear();
+
+            nBefore = g_nLiveBytes;
+            cMotionBatch oBatch;
+            std::vector<cCompactMotion> vecCompact;
+            oBatch.LoadCompact(vecSession, vecCompact);
+            std::size_t nCompactBytes = g_nLiveBytes - nBefore;
+
+            const double fMB = 1024.0 * 1024.0;
+            std::cout << "  library x8 keeps " << std::setprecision(2) << nFloatBytes / fMB << " MB as cKinectCSV, "
+                      << nCompactBytes / fMB << " MB from cMotionBatch::LoadCompact" << std::endl;
+        }
+
+        cKinectCSV oKinect;
+        oKinect.LoadFromFile(sFilename);
+
+        std::vector<sJointKinematics> vecKinematics;
+        Report("cKinectCSV::GetKinematics", nBytes, Measure([&]
+        {
+            oKinect.GetKinematics(0, oKinect.Size(), vecKinematics);
+            return vecKinematics[0].vecSpeed.size();
+        }));
+
+        cJointIndex oIndex;
+        Report("cJointIndex::Build", nBytes, Measure([&]
+        {
+            oIndex.Build(oKinect);
+            return oIndex.Size();
+        }));
+
+        // 1000 holds along the path of the right hand, records are queries
+        std::vector<cVector3<float>> vecHand(oKinect.Size());
+        oKinect.ExportJoint(JT_HandRight, 0, oKinect.Size(), vecHand.data());
+        std::vector<cJointIndex::sHit> vecHits;
+        Report("cJointIndex::Radius x1000", nBytes, Measure([&]
+        {
+            std::size_t nHits = 0;
+            for (std::size_t nQuery=0; nQuery<1000; ++nQuery)
+            {
+                oIndex.Radius(JT_HandRight, vecHand[1 + nQuery * (vecHand.size() - 1) / 1000], 0.1f, vecHits);
+                nHits += vecHits.size();
+            }
+            g_fSink = static_cast<double>(nHits);
+            return static_cast<std::size_t>(1000);
+        }));
+        Report("cJointIndex::Nearest x1000", nBytes, Measure([&]
+        {
+            for (std::size_t nQuery=0; nQuery<1000; ++nQuery)
+            {
+                oIndex.Nearest(JT_HandRight, vecHand[1 + nQuery * (vecHand.size() - 1) / 1000], 10, vecHits);
+            }
+            return static_cast<std::size_t>(1000);
+        }));
+
+        // a hold every 100 frames along the path of the right hand, back in camera space
+        std::vector<cVector3<float>> vecHolds;
+        for (std::size_t nFrame=1; nFrame<vecHand.size(); nFrame+=100)
+        {
+            const cVector3<float>& oHand = vecHand[nFrame];
+            vecHolds.push_back(cVector3<float>(0.05f - oHand[0], oHand[1] - 0.3f, 0.1f - oHand[2]));
+        }
+        cContactDetector oContacts;
+        oContacts.SetHolds(vecHolds);
+        Report("cKinectCSV::DetectContacts", nBytes, Measure([&]
+        {
+            oKinect.DetectContacts(oContacts);
+            return oContacts.Size();
+        }));
+
+        // a motion library keeps the quantized frames, MB is the size of the compact motion
+        cCompactMotion oCompact;
+        oKinect.GetCompactMotion(oCompact);
+        Report("cCompactMotion::Encode", oCompact.Bytes(), Measure([&]
+        {
+            cCompactMotion oEncoded;
+            oKinect.GetCompactMotion(oEncoded);
+            return oEncoded.Size();
+        }));
+
+        Report("cCompactMotion::Decode", oCompact.Bytes(), Measure([&]
+        {
+            float aPositions[cFrameArena::nColumns];
+            double fChecksum = 0.0;
+            for (std::size_t nFrame=0; nFrame<oCompact.Size(); ++nFrame)
+            {
+                oCompact.Decode(nFrame, aPositions);
+                fChecksum += aPositions[JT_HandTipRight * 3];
+            }
+            g_fSink = fChecksum;
+            return oCompact.Size();
+        }));
+    }
+
+
+    void BenchGeo(const std::string& sDirectory, std::size_t nRecords)
+    {
+        std::string sFilename = sDirectory + "/geo_" + std::to_string(nRecords) + ".dat";
+        if (!FileExists(sFilename))
+        {
+            WriteGeoTable(sFilename, nRecords);
+        }
+        std::size_t nBytes = FileSize(sFilename);
+
+        Report("cGeoTableParser (Load.cpp)", nBytes, Measure([&]
+        {
+            cGeoTableParser oParser;
+            sGeoTable oTable;
+            oParser.LoadFromFile(sFilename, oTable);
+            return oTable.Size();
+        }));
+    }
+
+
+    void BenchDepth(const std::string& sDirectory, std::size_t nRecords)
+    {
+        std::string sFilename = sDirectory + "/depth_" + std::to_string(nRecords) + ".png";
+        if (!FileExists(sFilename))
+        {
+            WriteDepthPNG(sFilename, nRecords);
+        }
+        std::size_t nBytes = FileSize(sFilename);
+
+        // what Wall.cpp does: decode into 8 bit RGBA
+        Report("lodepng RGBA8 (Wall.cpp)", nBytes, Measure([&]
+        {
+            std::vector<unsigned char> vecImage;
+            unsigned nWidth = 0;
+            unsigned nHeight = 0;
+            lodepng::decode(vecImage, nWidth, nHeight, sFilename);
+            return static_cast<std::size_t>(nWidth) * nHeight;
+        }));
+
+        Report("lodepng grey 16 bit", nBytes, Measure([&]
+        {
+            std::vector<unsigned char> vecImage;
+            unsigned nWidth = 0;
+            unsigned nHeight = 0;
+            lodepng::decode(vecImage, nWidth, nHeight, sFilename, LCT_GREY, 16);
+            return static_cast<std::size_t>(nWidth) * nHeight;
+        }));
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    std::string sDirectory = (argc > 1) ? argv[1] : "/tmp/loader_bench";
+    std::size_t nMaxRecords = (argc > 2) ? static_cast<std::size_t>(atof(argv[2])) : 100000;
+
+    mkdir(sDirectory.c_str(), 0755);
+
+    std::cout << std::left << std::setw(28) << "loader" << std::right
+              << std::setw(10) << "records" << std::setw(10) << "MB"
+              << std::setw(11) << "ms" << std::setw(13) << "records/s"
+              << std::setw(9) << "MB/s" << std::setw(11) << "allocs"
+              << std::setw(10) << "heap MB" << std::setw(10) << "peak MB"
+              << std::setw(10) << "RSS MB" << std::endl;
+
+    for (std::size_t nRecords=1000; nRecords<=nMaxRecords; nRecords *= 10)
+    {
+        std::cout << "-- " << nRecords << " records" << std::endl;
+        BenchSkeleton(sDirectory, nRecords);
+        BenchGeo(sDirectory, nRecords);
+        BenchDepth(sDirectory, nRecords);
+    }
+
+    return 0;
+}
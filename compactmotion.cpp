@@ -0,0 +1,222 @@
+#include "compactmotion.h"
+#include "skeletontopology.h"
+
+#include <cmath>
+
+
+const int cCompactMotion::nRootUnits;
+const int cCompactMotion::nLengthUnits;
+const int cCompactMotion::nDirectionBits;
+const int cCompactMotion::nLengthBits;
+const std::size_t cCompactMotion::nBones;
+const std::size_t cCompactMotion::nFrameBytes;
+
+
+namespace
+{
+    const std::uint32_t nDirectionMax = (1u << cCompactMotion::nDirectionBits) - 1;
+    const std::uint32_t nLengthMax = (1u << cCompactMotion::nLengthBits) - 1;
+
+    float SignNotZero(float fValue)
+    {
+        return (fValue < 0.0f) ? -1.0f : 1.0f;
+    }
+
+
+    std::uint32_t Quantize(float fValue, float fScale, std::uint32_t nMax)
+    {
+        float fUnits = std::floor(fValue * fScale + 0.5f);
+        return (fUnits <= 0.0f) ? 0 : (fUnits >= nMax) ? nMax : static_cast<std::uint32_t>(fUnits);
+    }
+
+
+    // unit vector from the two octahedral coordinates of a bone word
+    void DecodeDirection(std::uint32_t nWord, float& fX, float& fY, float& fZ)
+    {
+        const float fScale = 2.0f / nDirectionMax;
+        fX = (nWord & nDirectionMax) * fScale - 1.0f;
+        fY = ((nWord >> cCompactMotion::nDirectionBits) & nDirectionMax) * fScale - 1.0f;
+        fZ = 1.0f - std::fabs(fX) - std::fabs(fY);
+        if (fZ < 0.0f)
+        {
+            float fFoldedX = (1.0f - std::fabs(fY)) * SignNotZero(fX);
+            fY = (1.0f - std::fabs(fX)) * SignNotZero(fY);
+            fX = fFoldedX;
+        }
+        float fNorm = 1.0f / std::sqrt(fX * fX + fY * fY + fZ * fZ);
+        fX *= fNorm;
+        fY *= fNorm;
+        fZ *= fNorm;
+    }
+
+
+    std::uint32_t EncodeBone(float fX, float fY, float fZ)
+    {
+        float fLength = std::sqrt(fX * fX + fY * fY + fZ * fZ);
+        float fSum = std::fabs(fX) + std::fabs(fY) + std::fabs(fZ);
+        float fU = 0.0f;
+        float fV = 0.0f;
+        if (fSum > 0.0f)
+        {
+            fU = fX / fSum;
+            fV = fY / fSum;
+            if (fZ < 0.0f)
+            {
+                float fFoldedU = (1.0f - std::fabs(fV)) * SignNotZero(fU);
+                fV = (1.0f - std::fabs(fU)) * SignNotZero(fV);
+                fU = fFoldedU;
+            }
+        }
+
+        const float fScale = nDirectionMax * 0.5f;
+        return Quantize(fU + 1.0f, fScale, nDirectionMax)
+             | (Quantize(fV + 1.0f, fScale, nDirectionMax) << cCompactMotion::nDirectionBits)
+             | (Quantize(fLength, cCompactMotion::nLengthUnits, nLengthMax) << (2 * cCompactMotion::nDirectionBits));
+    }
+
+
+    // child joint at the end of the bone that starts at the parent joint
+    void PlaceChild(std::uint32_t nWord, const float* pParent, float* pChild)
+    {
+        float fX, fY, fZ;
+        DecodeDirection(nWord, fX, fY, fZ);
+        float fLength = (nWord >> (2 * cCompactMotion::nDirectionBits)) * (1.0f / cCompactMotion::nLengthUnits);
+        pChild[0] = pParent[0] + fX * fLength;
+        pChild[1] = pParent[1] + fY * fLength;
+        pChild[2] = pParent[2] + fZ * fLength;
+    }
+
+
+    void DecodeRoot(const std::int16_t* pRoot, float* pPositions)
+    {
+        for (int nAxis=0; nAxis<3; ++nAxis)
+        {
+            pPositions[JT_SpineBase * 3 + nAxis] = pRoot[nAxis] * (1.0f / cCompactMotion::nRootUnits);
+        }
+    }
+}
+
+
+cCompactMotion::cCompactMotion()
+{
+}
+
+
+std::size_t cCompactMotion::Size() const
+{
+    return m_vecTime.size();
+}
+
+
+bool cCompactMotion::Empty() const
+{
+    return m_vecTime.empty();
+}
+
+
+void cCompactMotion::Clear()
+{
+    m_vecTime.clear();
+    m_vecRoot.clear();
+    m_vecBones.clear();
+}
+
+
+void cCompactMotion::Reserve(std::size_t nFrames)
+{
+    m_vecTime.reserve(nFrames);
+    m_vecRoot.reserve(nFrames * 3);
+    m_vecBones.reserve(nFrames * nBones);
+}
+
+
+std::size_t cCompactMotion::Bytes() const
+{
+    return m_vecTime.capacity() * sizeof(std::int64_t) + m_vecRoot.capacity() * sizeof(std::int16_t)
+         + m_vecBones.capacity() * sizeof(std::uint32_t);
+}
+
+
+std::size_t cCompactMotion::PushBack(std::int64_t nTime, const float* pPositions)
+{
+    m_vecTime.push_back(nTime);
+
+    std::int16_t aRoot[3];
+    for (int nAxis=0; nAxis<3; ++nAxis)
+    {
+        float fUnits = std::floor(pPositions[JT_SpineBase * 3 + nAxis] * nRootUnits + 0.5f);
+        fUnits = (fUnits < -32768.0f) ? -32768.0f : (fUnits > 32767.0f) ? 32767.0f : fUnits;
+        aRoot[nAxis] = static_cast<std::int16_t>(fUnits);
+        m_vecRoot.push_back(aRoot[nAxis]);
+    }
+
+    // every bone starts at the parent as the decoder will see it, the
+    // quantization error of the parent is taken up by the child's bone
+    float aDecoded[cFrameArena::nColumns];
+    DecodeRoot(aRoot, aDecoded);
+    std::uint32_t aBones[nBones];
+    for (std::size_t nBone=0; nBone<nBones; ++nBone)
+    {
+        const sBone& oBone = aForwardBones[nBone];
+        const float* pParent = aDecoded + oBone.eParent * 3;
+        const float* pChild = pPositions + oBone.eChild * 3;
+        aBones[nBone] = EncodeBone(pChild[0] - pParent[0], pChild[1] - pParent[1], pChild[2] - pParent[2]);
+        PlaceChild(aBones[nBone], pParent, aDecoded + oBone.eChild * 3);
+    }
+    m_vecBones.insert(m_vecBones.end(), aBones, aBones + nBones);
+
+    return m_vecTime.size() - 1;
+}
+
+
+void cCompactMotion::Encode(const cFrameArena& oFrames)
+{
+    Clear();
+    Reserve(oFrames.Size());
+
+    float aPositions[cFrameArena::nColumns];
+    for (std::size_t nChunk=0; nChunk<oFrames.ChunkCount(); ++nChunk)
+    {
+        const std::int64_t* pTimes = oFrames.ChunkTimes(nChunk);
+        for (std::size_t nOffset=0; nOffset<oFrames.ChunkSize(nChunk); ++nOffset)
+        {
+            for (std::size_t nColumn=0; nColumn<cFrameArena::nColumns; ++nColumn)
+            {
+                aPositions[nColumn] = oFrames.ChunkColumn(nChunk, nColumn)[nOffset];
+            }
+            PushBack(pTimes[nOffset], aPositions);
+        }
+    }
+}
+
+
+std::int64_t cCompactMotion::Time(std::size_t nFrame) const
+{
+    return m_vecTime[nFrame];
+}
+
+
+void cCompactMotion::Decode(std::size_t nFrame, float* pPositions) const
+{
+    // the parent of every bone is placed before the bone
+    DecodeRoot(m_vecRoot.data() + nFrame * 3, pPositions);
+    const std::uint32_t* pBones = m_vecBones.data() + nFrame * nBones;
+    for (std::size_t nBone=0; nBone<nBones; ++nBone)
+    {
+        const sBone& oBone = aForwardBones[nBone];
+        PlaceChild(pBones[nBone], pPositions + oBone.eParent * 3, pPositions + oBone.eChild * 3);
+    }
+}
+
+
+void cCompactMotion::Decode(std::size_t nFirst, std::size_t nEnd, cFrameArena& oFrames) const
+{
+    nEnd = (nEnd < Size()) ? nEnd : Size();
+
+    float aPositions[cFrameArena::nColumns];
+    for (std::size_t nFrame=nFirst; nFrame<nEnd; ++nFrame)
+    {
+        Decode(nFrame, aPositions);
+        oFrames.PushBack(m_vecTime[nFrame], aPositions);
+    }
+}
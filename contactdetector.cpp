@@ -0,0 +1,186 @@
+#include "contactdetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+const std::size_t cContactDetector::nExtremities;
+const eJointType cContactDetector::aExtremities[cContactDetector::nExtremities] =
+    {JT_HandLeft, JT_HandRight, JT_FootLeft, JT_FootRight};
+const std::int32_t cContactDetector::nNoHold;
+
+
+cContactDetector::cContactDetector(float fTouchRadius, float fReleaseRadius) :
+    m_fTouchRadius(fTouchRadius),
+    m_fReleaseRadius(std::max(fReleaseRadius, fTouchRadius)),
+    m_fInverseCellSize(1.0f / std::max(m_fReleaseRadius, 1e-3f)),
+    m_nMask(0)
+{
+    SetHolds(std::vector<cVector3<float>>());
+}
+
+
+void cContactDetector::SetHolds(const std::vector<cVector3<float>>& vecHolds)
+{
+    m_vecHolds = vecHolds;
+
+    // about two buckets per hold, few holds share one
+    std::uint32_t nBuckets = 16;
+    while (nBuckets < 2 * m_vecHolds.size())
+    {
+        nBuckets <<= 1;
+    }
+    m_nMask = nBuckets - 1;
+
+    std::vector<std::uint32_t> vecBuckets(m_vecHolds.size());
+    m_vecOffsets.assign(nBuckets + 1, 0);
+    for (std::size_t i=0; i<m_vecHolds.size(); ++i)
+    {
+        vecBuckets[i] = Bucket(Cell(m_vecHolds[i][0]), Cell(m_vecHolds[i][1]), Cell(m_vecHolds[i][2]), m_nMask);
+        ++m_vecOffsets[vecBuckets[i] + 1];
+    }
+    for (std::uint32_t b=0; b<nBuckets; ++b)
+    {
+        m_vecOffsets[b + 1] += m_vecOffsets[b];
+    }
+    std::vector<std::uint32_t> vecFill(m_vecOffsets.begin(), m_vecOffsets.end() - 1);
+    m_vecBucketHolds.resize(m_vecHolds.size());
+    for (std::size_t i=0; i<m_vecHolds.size(); ++i)
+    {
+        m_vecBucketHolds[vecFill[vecBuckets[i]]++] = static_cast<std::uint32_t>(i);
+    }
+
+    Reset();
+}
+
+
+std::size_t cContactDetector::Holds() const
+{
+    return m_vecHolds.size();
+}
+
+
+const cVector3<float>& cContactDetector::Hold(std::size_t nHold) const
+{
+    return m_vecHolds[nHold];
+}
+
+
+void cContactDetector::Reset()
+{
+    m_vecContacts.clear();
+    m_vecTimelines.assign(m_vecHolds.size(), std::vector<sHoldContact>());
+    for (std::size_t i=0; i<nExtremities; ++i)
+    {
+        m_aHold[i] = nNoHold;
+        m_aTimelineEntry[i] = 0;
+    }
+}
+
+
+int cContactDetector::Cell(float fCoordinate) const
+{
+    // far outside of any wall, keeps the cell coordinates small
+    float fCell = std::floor(fCoordinate * m_fInverseCellSize);
+    fCell = (fCell < -1e6f) ? -1e6f : (fCell > 1e6f) ? 1e6f : fCell;
+    return static_cast<int>(fCell);
+}
+
+
+std::uint32_t cContactDetector::Bucket(int nX, int nY, int nZ, std::uint32_t nMask)
+{
+    return (static_cast<std::uint32_t>(nX) * 73856093u
+            ^ static_cast<std::uint32_t>(nY) * 19349663u
+            ^ static_cast<std::uint32_t>(nZ) * 83492791u) & nMask;
+}
+
+
+float cContactDetector::Distance2(std::int32_t nHold, const float* pPosition) const
+{
+    const cVector3<float>& oHold = m_vecHolds[nHold];
+    float fX = pPosition[0] - oHold[0];
+    float fY = pPosition[1] - oHold[1];
+    float fZ = pPosition[2] - oHold[2];
+    return fX * fX + fY * fY + fZ * fZ;
+}
+
+
+std::int32_t cContactDetector::FindHold(const float* pPosition) const
+{
+    // the cells are as large as the release radius, so the cell of the
+    // extremity and its neighbours hold every hold in reach; a bucket shared
+    // by two of them is searched twice, which does not change the nearest
+    std::int32_t nNearest = nNoHold;
+    float fNearest2 = m_fTouchRadius * m_fTouchRadius;
+    int nX = Cell(pPosition[0]);
+    int nY = Cell(pPosition[1]);
+    int nZ = Cell(pPosition[2]);
+    for (int dX=-1; dX<=1; ++dX)
+    {
+        for (int dY=-1; dY<=1; ++dY)
+        {
+            for (int dZ=-1; dZ<=1; ++dZ)
+            {
+                std::uint32_t nBucket = Bucket(nX + dX, nY + dY, nZ + dZ, m_nMask);
+                for (std::uint32_t i=m_vecOffsets[nBucket]; i<m_vecOffsets[nBucket + 1]; ++i)
+                {
+                    std::int32_t nHold = static_cast<std::int32_t>(m_vecBucketHolds[i]);
+                    float fDistance2 = Distance2(nHold, pPosition);
+                    if (fDistance2 <= fNearest2)
+                    {
+                        fNearest2 = fDistance2;
+                        nNearest = nHold;
+                    }
+                }
+            }
+        }
+    }
+    return nNearest;
+}
+
+
+void cContactDetector::AddFrame(const float* pPositions)
+{
+    std::size_t nFrame = Size();
+    float fRelease2 = m_fReleaseRadius * m_fReleaseRadius;
+    for (std::size_t i=0; i<nExtremities; ++i)
+    {
+        std::int32_t nHold = nNoHold;
+        if (pPositions)
+        {
+            const float* pPosition = pPositions + aExtremities[i] * 3;
+            nHold = (m_aHold[i] != nNoHold && Distance2(m_aHold[i], pPosition) <= fRelease2)
+                ? m_aHold[i] : FindHold(pPosition);
+        }
+
+        if (nHold != nNoHold && nHold == m_aHold[i])
+        {
+            m_vecTimelines[nHold][m_aTimelineEntry[i]].nEnd = nFrame + 1;
+        }
+        else if (nHold != nNoHold)
+        {
+            m_aTimelineEntry[i] = m_vecTimelines[nHold].size();
+            m_vecTimelines[nHold].push_back({i, nFrame, nFrame + 1});
+        }
+        m_aHold[i] = nHold;
+        m_vecContacts.push_back(nHold);
+    }
+}
+
+
+std::size_t cContactDetector::Size() const
+{
+    return m_vecContacts.size() / nExtremities;
+}
+
+
+std::int32_t cContactDetector::Contact(std::size_t nFrame, std::size_t nExtremity) const
+{
+    return m_vecContacts[nFrame * nExtremities + nExtremity];
+}
+
+
+const std::vector<sHoldContact>& cContactDetector::Timeline(std::size_t nHold) const
+{
+    return m_vecTimelines[nHold];
+}
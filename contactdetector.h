@@ -0,0 +1,81 @@
+#ifndef CCONTACTDETECTOR_H
+#define CCONTACTDETECTOR_H
+
+#include "joint.h"
+#include "vector3.hpp"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+
+// an extremity on a hold during the frames [nFirst, nEnd)
+struct sHoldContact
+{
+  std::size_t nExtremity;
+  std::size_t nFirst;
+  std::size_t nEnd;
+};
+
+
+/* Which hold each hand and foot touches, frame by frame. The holds (hold
+ * candidates of the depth image) and the frames are in the camera space of
+ * cHierarchicMotion. An extremity takes the nearest hold within the touch
+ * radius and keeps it until it is farther away than the release radius, so
+ * the sensor noise at the border does not make contacts flicker. The holds
+ * sit in a spatial hash with cells as large as the release radius, a frame
+ * looks at 27 cells per extremity. Frames are added one by one, from a
+ * loaded motion (cKinectCSV::DetectContacts) as well as live. */
+class cContactDetector
+{
+public:
+  static const std::size_t nExtremities = 4;
+  static const eJointType aExtremities[nExtremities];
+  static const std::int32_t nNoHold = -1;
+
+  // radii in m, the release radius is at least the touch radius
+  cContactDetector(float fTouchRadius = 0.08f, float fReleaseRadius = 0.12f);
+
+  void SetHolds(const std::vector<cVector3<float>>& vecHolds);
+  std::size_t Holds() const;
+  const cVector3<float>& Hold(std::size_t nHold) const;
+  // forgets the frames, the holds stay
+  void Reset();
+
+  // a frame in the cFrameArena layout; NULL for a frame without skeleton,
+  // which releases all holds
+  void AddFrame(const float* pPositions);
+
+  // frames added since Reset
+  std::size_t Size() const;
+  // hold touched by aExtremities[nExtremity] in the frame, nNoHold if none
+  std::int32_t Contact(std::size_t nFrame, std::size_t nExtremity) const;
+  // contacts of a hold in the order they began, the last ones may still go on
+  const std::vector<sHoldContact>& Timeline(std::size_t nHold) const;
+
+private:
+  float m_fTouchRadius;
+  float m_fReleaseRadius;
+  float m_fInverseCellSize;
+
+  std::vector<cVector3<float>> m_vecHolds;
+  // holds of bucket b are m_vecBucketHolds[m_vecOffsets[b], m_vecOffsets[b + 1])
+  std::vector<std::uint32_t> m_vecOffsets;
+  std::vector<std::uint32_t> m_vecBucketHolds;
+  std::uint32_t m_nMask;
+
+  // nExtremities per frame
+  std::vector<std::int32_t> m_vecContacts;
+  std::vector<std::vector<sHoldContact>> m_vecTimelines;
+  // current hold per extremity, and its running entry in the timeline
+  std::int32_t m_aHold[nExtremities];
+  std::size_t m_aTimelineEntry[nExtremities];
+
+  int Cell(float fCoordinate) const;
+  static std::uint32_t Bucket(int nX, int nY, int nZ, std::uint32_t nMask);
+  // nearest hold within the touch radius, nNoHold if there is none
+  std::int32_t FindHold(const float* pPosition) const;
+  float Distance2(std::int32_t nHold, const float* pPosition) const;
+};
+
+#endif // CCONTACTDETECTOR_H
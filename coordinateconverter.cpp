@@ -19,8 +19,8 @@ cCoordinateConverter::cCoordinateConverter(int scrHghtX, int scrWdthY, float hFV
 
 void cCoordinateConverter::setScreenCenter()
 {
-  screenCenterX = screenWidth / 2;
-  screenCenterY = screenHeight / 2;
+  screenCenterX = static_cast<float>(screenWidth) / 2.0f;
+  screenCenterY = static_cast<float>(screenHeight) / 2.0f;
 }
 
 
@@ -39,35 +39,18 @@ void cCoordinateConverter::depthToWorld(int depthX, int depthY, int depthZ,
 {
   worldZ = rawDepthToMeters(depthZ);
 
-  if ((screenCenterX - depthX) && (screenCenterY - depthY))
-  {
-    worldX = worldZ * static_cast<float>(screenCenterX - depthX) / f_x;
-    worldY = worldZ * static_cast<float>(screenCenterY - depthY) / f_y;
-
-    float flupp = worldX;
-    worldX = worldY;
-    worldY = flupp;
-  }
-  else
-  {
-    worldX = 0.0f;
-    worldY = 0.0f;
-    worldZ = 0.0f;
-  }
+  // column about the horizontal centre, row about the vertical one (image rows grow downwards)
+  worldX = worldZ * (static_cast<float>(depthX) - screenCenterX) / f_x;
+  worldY = worldZ * (screenCenterY - static_cast<float>(depthY)) / f_y;
 }
 
 
 float cCoordinateConverter::rawDepthToMeters(int rawDepth)
 {
-  float rawDepthF = static_cast<double>(rawDepth);
-
-  if (rawDepth <= 0xFFFF)
+  // the kinect v2 depth frames hold millimetres, 0 where nothing was measured
+  if (rawDepth > 0 && rawDepth <= 0xFFFF)
   {
-    // following values acquired during kinect v2 depth sensor calibration
-    // xtion value -> float depth = 3.33776840956e-05f * rawDepthF + -0.0674169620271f;
-    float depth = (0.012432f * rawDepthF + -1.475340f) / 100.0f;
-
-    return (depth);
+    return static_cast<float>(rawDepth) / 1000.0f;
   }
   return 0.0f;
 }
@@ -4,6 +4,11 @@
 #define _USE_MATH_DEFINES
 #include <cmath>
 
+/* Projects a pixel of a Kinect v2 depth frame into the camera space of the
+ * sensor: depthX is the column, depthY the row and depthZ the raw depth in
+ * millimetres. The frames are mirrored, so x grows with the column; y points
+ * up and z away from the sensor, all in metres. Pixels without a measurement
+ * (raw depth 0) give (0, 0, 0). */
 class cCoordinateConverter
 {
   public:
@@ -20,8 +25,8 @@ class cCoordinateConverter
     const float horizontalFieldOfView;
     const float verticalFieldOfView;
 
-    int screenCenterX;
-    int screenCenterY;
+    float screenCenterX;
+    float screenCenterY;
 
     float f_x;
     float f_y;
@@ -6,6 +6,7 @@
 #include <sstream>
 #include <vector>
 #include <string>
+#include <cstring>
 
 
 /* *************** CSVRow ****************************************************/
@@ -98,3 +99,126 @@ bool cCSVIterator::operator!=(cCSVIterator const &rhs)
 {
     return !((*this) == rhs);
 }
+
+
+/* *************** CSVMappedRow **********************************************/
+cCSVCell const& cCSVMappedRow::operator[](std::size_t index) const
+{
+    return m_data[index];
+}
+
+
+std::size_t cCSVMappedRow::size() const
+{
+    return m_data.size();
+}
+
+
+const char* cCSVMappedRow::readNextRow(const char* pBegin, const char* pEnd, char cDelimiter)
+{
+    const char* pLineEnd = static_cast<const char*>(memchr(pBegin, '\n', pEnd - pBegin));
+    const char* pNext = pLineEnd ? pLineEnd + 1 : pEnd;
+    if (!pLineEnd)
+    {
+        pLineEnd = pEnd;
+    }
+
+    // recordings are written on windows, drop the carriage return
+    if (pLineEnd > pBegin && *(pLineEnd - 1) == '\r')
+    {
+        --pLineEnd;
+    }
+
+    // same splitting rules as std::getline: no empty cell after a trailing delimiter
+    m_data.clear();
+    const char* pCell = pBegin;
+    while (pCell < pLineEnd)
+    {
+        const char* pDelimiter = static_cast<const char*>(memchr(pCell, cDelimiter, pLineEnd - pCell));
+        if (!pDelimiter)
+        {
+            pDelimiter = pLineEnd;
+        }
+        m_data.push_back(cCSVCell(pCell, pDelimiter - pCell));
+        pCell = pDelimiter + 1;
+    }
+
+    return pNext;
+}
+
+
+/* *************** CSVMappedIterator *****************************************/
+cCSVMappedIterator::cCSVMappedIterator(const cMappedFile& oFile) :
+    m_pCur(oFile.IsOpen() ? oFile.Begin() : NULL),
+    m_pEnd(oFile.IsOpen() ? oFile.End() : NULL)
+{
+    ++(*this);
+}
+
+
+cCSVMappedIterator::cCSVMappedIterator(const char* pBegin, const char* pEnd) :
+    m_pCur(pBegin),
+    m_pEnd(pEnd)
+{
+    ++(*this);
+}
+
+
+cCSVMappedIterator::cCSVMappedIterator() : m_pCur(NULL), m_pEnd(NULL) { }
+
+
+// Pre Increment
+cCSVMappedIterator& cCSVMappedIterator::operator++()
+{
+    if (m_pCur)
+    {
+        if (m_pCur >= m_pEnd)
+        {
+            m_pCur = NULL;
+        }
+        else
+        {
+            m_pCur = m_row.readNextRow(m_pCur, m_pEnd);
+        }
+    }
+    return *this;
+}
+
+
+// Post increment
+cCSVMappedIterator cCSVMappedIterator::operator++(int)
+{
+    cCSVMappedIterator tmp(*this);
+    ++(*this);
+    return tmp;
+}
+
+
+cCSVMappedRow const& cCSVMappedIterator::operator*() const
+{
+    return m_row;
+}
+
+
+cCSVMappedRow const* cCSVMappedIterator::operator->() const
+{
+    return &m_row;
+}
+
+
+const char* cCSVMappedIterator::Position() const
+{
+    return m_pCur ? m_pCur : m_pEnd;
+}
+
+
+bool cCSVMappedIterator::operator==(cCSVMappedIterator const& rhs)
+{
+    return ((this == &rhs) || ((this->m_pCur == NULL) && (rhs.m_pCur == NULL)));
+}
+
+
+bool cCSVMappedIterator::operator!=(cCSVMappedIterator const &rhs)
+{
+    return !((*this) == rhs);
+}
@@ -8,6 +8,8 @@
 #include <vector>
 #include <string>
 
+#include "mappedfile.h"
+
 
 class cCSVRow
 {
@@ -49,4 +51,73 @@ class cCSVIterator
         cCSVRow m_row;
 };
 
+
+/* Non-owning view of a single cell inside a mapped file */
+class cCSVCell
+{
+    public:
+        cCSVCell() : m_pData(NULL), m_nSize(0) { }
+        cCSVCell(const char* pData, std::size_t nSize) : m_pData(pData), m_nSize(nSize) { }
+
+        const char* data() const { return m_pData; }
+        const char* begin() const { return m_pData; }
+        const char* end() const { return m_pData + m_nSize; }
+        std::size_t size() const { return m_nSize; }
+        bool empty() const { return m_nSize == 0; }
+
+        std::string ToString() const { return std::string(m_pData, m_nSize); }
+
+    private:
+        const char* m_pData;
+        std::size_t m_nSize;
+};
+
+
+/* Row of cells pointing into a mapped file; the cell array is reused between
+ * rows, so reading a row does not allocate once the first row has been read */
+class cCSVMappedRow
+{
+    public:
+        cCSVCell const& operator[](std::size_t index) const;
+        std::size_t size() const;
+        const char* readNextRow(const char* pBegin, const char* pEnd, char cDelimiter = '\t');
+
+    private:
+        std::vector<cCSVCell> m_data;
+};
+
+
+class cCSVMappedIterator
+{
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef cCSVMappedRow            value_type;
+        typedef std::size_t             difference_type;
+        typedef cCSVMappedRow*           pointer;
+        typedef cCSVMappedRow&           reference;
+
+        cCSVMappedIterator(const cMappedFile& oFile);
+        cCSVMappedIterator(const char* pBegin, const char* pEnd);
+        cCSVMappedIterator();
+
+        // Pre Increment
+        cCSVMappedIterator& operator++();
+
+        // Post increment
+        cCSVMappedIterator operator++(int);
+        cCSVMappedRow const& operator*() const;
+        cCSVMappedRow const* operator->() const;
+
+        // position behind the current row, e.g. to resume reading later
+        const char* Position() const;
+
+        bool operator==(cCSVMappedIterator const& rhs);
+        bool operator!=(cCSVMappedIterator const &rhs);
+
+    private:
+        const char* m_pCur;
+        const char* m_pEnd;
+        cCSVMappedRow m_row;
+};
+
 #endif // CSVREADER_H
@@ -0,0 +1,193 @@
+#ifndef DECIMATION_H
+#define DECIMATION_H
+
+#include "parallel.h"
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+
+namespace decimation
+{
+  // block ends are always kept: a few more points, but no quadratic scans over a whole recording
+  const std::size_t nMaxRange = 512;
+
+  // squared distances of points to the segment oA-oB
+  class cSegment
+  {
+  public:
+    template<class tPoint>
+    cSegment(const tPoint& oA, const tPoint& oB) :
+      m_aStart{oA[0], oA[1], oA[2]},
+      m_aDelta{oB[0] - oA[0], oB[1] - oA[1], oB[2] - oA[2]}
+    {
+      double fLength = m_aDelta[0] * m_aDelta[0] + m_aDelta[1] * m_aDelta[1] + m_aDelta[2] * m_aDelta[2];
+      m_fInverseLength = (fLength > 0.0) ? 1.0 / fLength : 0.0;
+    }
+
+    template<class tPoint>
+    double SquaredDistance(const tPoint& oPoint) const
+    {
+      double fX = oPoint[0] - m_aStart[0];
+      double fY = oPoint[1] - m_aStart[1];
+      double fZ = oPoint[2] - m_aStart[2];
+
+      // a climber comes back to the same spot, so project onto the segment, not the line
+      double fT = (fX * m_aDelta[0] + fY * m_aDelta[1] + fZ * m_aDelta[2]) * m_fInverseLength;
+      fT = (fT < 0.0) ? 0.0 : (fT > 1.0) ? 1.0 : fT;
+
+      fX -= fT * m_aDelta[0];
+      fY -= fT * m_aDelta[1];
+      fZ -= fT * m_aDelta[2];
+      return fX * fX + fY * fY + fZ * fZ;
+    }
+
+  private:
+    double m_aStart[3];
+    double m_aDelta[3];
+    double m_fInverseLength;
+  };
+
+
+  // marks the points DecimateLineStrip keeps, the strip has more than two points
+  template<class tPoint>
+  void Keep(const std::vector<tPoint>& vecPoints, double fTolerance, std::vector<bool>& vecKeep)
+  {
+    double fSquaredTolerance = fTolerance * fTolerance;
+    vecKeep.assign(vecPoints.size(), false);
+    vecKeep.front() = true;
+
+    // explicit stack of open ranges, a long recording would overflow the call stack
+    std::vector<std::pair<std::size_t, std::size_t>> vecRanges;
+    for (std::size_t nFirst=0; nFirst<vecPoints.size()-1; nFirst+=decimation::nMaxRange)
+    {
+      std::size_t nLast = (vecPoints.size() - 1 - nFirst > decimation::nMaxRange) ? nFirst + decimation::nMaxRange
+                                                                                  : vecPoints.size() - 1;
+      vecKeep[nLast] = true;
+      vecRanges.push_back(std::make_pair(nFirst, nLast));
+    }
+
+    while (!vecRanges.empty())
+    {
+      std::size_t nFirst = vecRanges.back().first;
+      std::size_t nLast = vecRanges.back().second;
+      vecRanges.pop_back();
+
+      decimation::cSegment oSegment(vecPoints[nFirst], vecPoints[nLast]);
+      double fMax = fSquaredTolerance;
+      std::size_t nSplit = nFirst;
+      for (std::size_t i=nFirst+1; i<nLast; ++i)
+      {
+        double fDistance = oSegment.SquaredDistance(vecPoints[i]);
+        if (fDistance > fMax)
+        {
+          fMax = fDistance;
+          nSplit = i;
+        }
+      }
+
+      if (nSplit != nFirst)
+      {
+        vecKeep[nSplit] = true;
+        vecRanges.push_back(std::make_pair(nFirst, nSplit));
+        vecRanges.push_back(std::make_pair(nSplit, nLast));
+      }
+    }
+  }
+
+
+  // moves the marked elements to the front and drops the rest
+  template<class tElement>
+  std::size_t Compact(std::vector<tElement>& vecElements, const std::vector<bool>& vecKeep)
+  {
+    std::size_t nKept = 0;
+    for (std::size_t i=0; i<vecElements.size(); ++i)
+    {
+      if (vecKeep[i])
+      {
+        vecElements[nKept++] = vecElements[i];
+      }
+    }
+    vecElements.resize(nKept);
+    return nKept;
+  }
+}
+
+
+/* Ramer-Douglas-Peucker simplification of a line strip: keeps the first and
+ * the last point and only those in between that are further than fTolerance
+ * away from the simplified strip, so no dropped point is off by more than
+ * fTolerance. Long strips are split into blocks of a few hundred points
+ * first, which bounds the cost on noisy data where the splits are uneven.
+ * Works in place on any point type with operator[] for x/y/z and returns
+ * the number of points kept. */
+template<class tPoint>
+std::size_t DecimateLineStrip(std::vector<tPoint>& vecPoints, double fTolerance)
+{
+  if (vecPoints.size() <= 2)
+  {
+    return vecPoints.size();
+  }
+
+  std::vector<bool> vecKeep;
+  decimation::Keep(vecPoints, fTolerance, vecKeep);
+  return decimation::Compact(vecPoints, vecKeep);
+}
+
+
+// the same, vecValues holds one value per point (e.g. a color) and keeps those of the kept points
+template<class tPoint, class tValue>
+std::size_t DecimateLineStrip(std::vector<tPoint>& vecPoints, std::vector<tValue>& vecValues, double fTolerance)
+{
+  if (vecPoints.size() <= 2)
+  {
+    return vecPoints.size();
+  }
+
+  std::vector<bool> vecKeep;
+  decimation::Keep(vecPoints, fTolerance, vecKeep);
+  decimation::Compact(vecValues, vecKeep);
+  return decimation::Compact(vecPoints, vecKeep);
+}
+
+
+// the same for every strip, the strips are spread over nThreads (0 = all cores)
+template<class tPoint>
+std::size_t DecimateLineStrips(std::vector<std::vector<tPoint>>& vecStrips, double fTolerance,
+                               unsigned nThreads = 0)
+{
+  std::vector<std::size_t> vecKept(vecStrips.size(), 0);
+  ParallelFor(0, vecStrips.size(), [&](std::size_t nStrip)
+  {
+    vecKept[nStrip] = DecimateLineStrip(vecStrips[nStrip], fTolerance);
+  }, nThreads);
+
+  std::size_t nKept = 0;
+  for (std::size_t n : vecKept)
+  {
+    nKept += n;
+  }
+  return nKept;
+}
+
+
+template<class tPoint, class tValue>
+std::size_t DecimateLineStrips(std::vector<std::vector<tPoint>>& vecStrips, std::vector<std::vector<tValue>>& vecValues,
+                               double fTolerance, unsigned nThreads = 0)
+{
+  std::vector<std::size_t> vecKept(vecStrips.size(), 0);
+  ParallelFor(0, vecStrips.size(), [&](std::size_t nStrip)
+  {
+    vecKept[nStrip] = DecimateLineStrip(vecStrips[nStrip], vecValues[nStrip], fTolerance);
+  }, nThreads);
+
+  std::size_t nKept = 0;
+  for (std::size_t n : vecKept)
+  {
+    nKept += n;
+  }
+  return nKept;
+}
+
+#endif // DECIMATION_H
@@ -41,6 +41,7 @@ namespace
                 add<DomainBase>("Points");
                 add<TensorFieldBase>("Tiefenwerte");
                 add<DomainBase>("Minima");
+                add<DomainBase>("Holds");
             }
         };
 
@@ -126,6 +127,13 @@ namespace
 
                 infoLog() << sFilename << " (" << oDepthImage.rows << ", " << oDepthImage.cols << ")\n";
 
+                // the converter needs the raw millimetres of the sensor, an 8 bit image has lost them
+                if (oDepthImage.type() != CV_16UC1)
+                {
+                    infoLog() << sFilename << " is not a 16 bit depth image\n";
+                    return;
+                }
+
                 std::vector<Point2> vecPositions;
                 std::vector<Scalar> vecDepthValues;
 
@@ -135,7 +143,7 @@ namespace
                     {
                         float fWorldX, fWorldY, fWorldZ;
                         cCoordinateConverter oCoordinateConverter;
-                        oCoordinateConverter.depthToWorld(nRow, nCol, oDepthImage.at<unsigned short>(nRow, nCol),
+                        oCoordinateConverter.depthToWorld(nCol, nRow, oDepthImage.at<unsigned short>(nRow, nCol),
                                                           fWorldX, fWorldY, fWorldZ);
                         vecPositions.push_back(Point2(fWorldX, fWorldY));
                         vecDepthValues.push_back(Scalar(fWorldZ));
@@ -164,6 +172,27 @@ namespace
 
                 auto minimaPoints  = DomainFactory::makeDomainArbitrary(vecMinimaPositions);
                 setResult("Minima", minimaPoints);
+
+                // hold candidates in the space of cHierarchicMotion, for the contact
+                // detection: camera space with x negated like in cKinectCSV::FeedFrames
+                std::vector<Point3> vecHoldPositions;
+                cCoordinateConverter oCoordinateConverter;
+                for (const cv::Point& oMinimum : minima)
+                {
+                    if (oMinimum.y < 0 || oMinimum.y >= oDepthImage.rows || oMinimum.x < 0 || oMinimum.x >= oDepthImage.cols)
+                    {
+                        continue;
+                    }
+                    float fWorldX, fWorldY, fWorldZ;
+                    oCoordinateConverter.depthToWorld(oMinimum.x, oMinimum.y, oDepthImage.at<unsigned short>(oMinimum.y, oMinimum.x),
+                                                      fWorldX, fWorldY, fWorldZ);
+                    // no depth measured at the minimum
+                    if (fWorldZ > 0.0f)
+                    {
+                        vecHoldPositions.push_back(Point3(-fWorldX, fWorldY, fWorldZ));
+                    }
+                }
+                setResult("Holds", DomainFactory::makeDomainArbitrary(vecHoldPositions));
             }
         }
 
@@ -176,7 +205,7 @@ namespace
                 {
                     float fWorldX, fWorldY, fWorldZ;
                     cCoordinateConverter oCoordinateConverter;
-                    oCoordinateConverter.depthToWorld(nRow, nCol, oDepthImage.at<unsigned short>(nRow, nCol),
+                    oCoordinateConverter.depthToWorld(nCol, nRow, oDepthImage.at<unsigned short>(nRow, nCol),
                                                       fWorldX, fWorldY, fWorldZ);
 
                 }
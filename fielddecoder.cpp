@@ -0,0 +1,248 @@
+#include "fielddecoder.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+
+
+namespace
+{
+    // exactly representable powers of ten, see ParseDouble
+    const double aPow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const std::uint64_t nMaxExactMantissa = (static_cast<std::uint64_t>(1) << 53);
+
+
+    inline bool IsDigit(char c)
+    {
+        return static_cast<unsigned>(c - '0') < 10u;
+    }
+
+
+    const char* SkipSpaces(const char* p, const char* pEnd)
+    {
+        while (p < pEnd && (*p == ' ' || *p == '\t'))
+        {
+            ++p;
+        }
+        return p;
+    }
+
+
+    // rare inputs (long mantissas, huge exponents) go through the C library
+    template<class T>
+    T SlowParse(const char* pBegin, const char* pEnd, T (*pConvert)(const char*, char**))
+    {
+        char aBuffer[128];
+        std::size_t nSize = static_cast<std::size_t>(pEnd - pBegin);
+        nSize = (nSize < sizeof(aBuffer) - 1) ? nSize : sizeof(aBuffer) - 1;
+        memcpy(aBuffer, pBegin, nSize);
+        aBuffer[nSize] = '\0';
+        return pConvert(aBuffer, NULL);
+    }
+
+
+    // a double that lies exactly halfway between two neighbouring floats;
+    // denormal floats have other midpoints and are treated as one too
+    bool IsFloatMidpoint(double fValue)
+    {
+        if (fValue == 0.0 || std::fabs(fValue) >= static_cast<double>(FLT_MAX))
+        {
+            return false;
+        }
+        if (std::fabs(fValue) < static_cast<double>(FLT_MIN))
+        {
+            return true;
+        }
+        std::uint64_t nBits;
+        memcpy(&nBits, &fValue, sizeof(nBits));
+        // 52 fraction bits of the double, 23 of the float
+        const std::uint64_t nLowMask = (static_cast<std::uint64_t>(1) << 29) - 1;
+        return (nBits & nLowMask) == (static_cast<std::uint64_t>(1) << 28);
+    }
+}
+
+
+const char* ParseDouble(const char* pBegin, const char* pEnd, double& fValue)
+{
+    const char* p = SkipSpaces(pBegin, pEnd);
+    const char* pStart = p;
+
+    bool bNegative = false;
+    if (p < pEnd && (*p == '-' || *p == '+'))
+    {
+        bNegative = (*p == '-');
+        ++p;
+    }
+
+    std::uint64_t nMantissa = 0;
+    int nDigits = 0;
+    int nExponent = 0;
+    bool bAnyDigit = false;
+    bool bTruncated = false;
+
+    for (; p < pEnd && IsDigit(*p); ++p)
+    {
+        bAnyDigit = true;
+        if (nDigits < 19)
+        {
+            nMantissa = nMantissa * 10 + static_cast<unsigned>(*p - '0');
+            nDigits += (nMantissa != 0);
+        }
+        else
+        {
+            ++nExponent;
+            bTruncated = true;
+        }
+    }
+
+    if (p < pEnd && *p == '.')
+    {
+        for (++p; p < pEnd && IsDigit(*p); ++p)
+        {
+            bAnyDigit = true;
+            if (nDigits < 19)
+            {
+                nMantissa = nMantissa * 10 + static_cast<unsigned>(*p - '0');
+                nDigits += (nMantissa != 0);
+                --nExponent;
+            }
+            else
+            {
+                bTruncated = true;
+            }
+        }
+    }
+
+    if (!bAnyDigit)
+    {
+        fValue = 0.0;
+        return pBegin;
+    }
+
+    if (p < pEnd && (*p == 'e' || *p == 'E'))
+    {
+        const char* pExponent = p + 1;
+        bool bNegativeExponent = false;
+        if (pExponent < pEnd && (*pExponent == '-' || *pExponent == '+'))
+        {
+            bNegativeExponent = (*pExponent == '-');
+            ++pExponent;
+        }
+        if (pExponent < pEnd && IsDigit(*pExponent))
+        {
+            int nExplicit = 0;
+            for (; pExponent < pEnd && IsDigit(*pExponent); ++pExponent)
+            {
+                nExplicit = (nExplicit < 10000) ? nExplicit * 10 + (*pExponent - '0') : nExplicit;
+            }
+            nExponent += bNegativeExponent ? -nExplicit : nExplicit;
+            p = pExponent;
+        }
+    }
+
+    // mantissa and power of ten are both exact doubles here, so a single
+    // multiplication or division gives the correctly rounded result
+    if (!bTruncated && nMantissa <= nMaxExactMantissa && nExponent >= -22 && nExponent <= 22)
+    {
+        double fResult = static_cast<double>(nMantissa);
+        fResult = (nExponent < 0) ? fResult / aPow10[-nExponent] : fResult * aPow10[nExponent];
+        fValue = bNegative ? -fResult : fResult;
+    }
+    else
+    {
+        fValue = SlowParse<double>(pStart, p, strtod);
+    }
+
+    return p;
+}
+
+
+const char* ParseFloat(const char* pBegin, const char* pEnd, float& fValue)
+{
+    // the double is correctly rounded, and rounding it once more to float
+    // only differs from rounding the decimal directly when it landed exactly
+    // on a float midpoint; those few values are left to strtof
+    double fDouble;
+    const char* p = ParseDouble(pBegin, pEnd, fDouble);
+    fValue = IsFloatMidpoint(fDouble) ? SlowParse<float>(SkipSpaces(pBegin, pEnd), p, strtof)
+                                      : static_cast<float>(fDouble);
+    return p;
+}
+
+
+const char* ParseInt64(const char* pBegin, const char* pEnd, std::int64_t& nValue)
+{
+    const char* p = SkipSpaces(pBegin, pEnd);
+
+    bool bNegative = false;
+    if (p < pEnd && (*p == '-' || *p == '+'))
+    {
+        bNegative = (*p == '-');
+        ++p;
+    }
+
+    if (p == pEnd || !IsDigit(*p))
+    {
+        nValue = 0;
+        return pBegin;
+    }
+
+    // values beyond the range saturate, all digits are consumed anyway
+    const std::uint64_t nLimit = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())
+                               + (bNegative ? 1 : 0);
+    std::uint64_t nResult = 0;
+    for (; p < pEnd && IsDigit(*p); ++p)
+    {
+        unsigned nDigit = static_cast<unsigned>(*p - '0');
+        nResult = (nResult > (nLimit - nDigit) / 10) ? nLimit : nResult * 10 + nDigit;
+    }
+
+    nValue = bNegative ? static_cast<std::int64_t>(0 - nResult) : static_cast<std::int64_t>(nResult);
+    return p;
+}
+
+
+const char* FindDelimiter(const char* pBegin, const char* pEnd, char cDelimiter)
+{
+    const char* pDelimiter = static_cast<const char*>(memchr(pBegin, cDelimiter, pEnd - pBegin));
+    return pDelimiter ? pDelimiter : pEnd;
+}
+
+
+std::size_t DecodeFloats(const char* pBegin, const char* pEnd, char cDelimiter,
+                         float* pOut, std::size_t nMax)
+{
+    return ForEachField(pBegin, pEnd, cDelimiter, nMax,
+                        [pOut](std::size_t nIndex, const char* pFieldBegin, const char* pFieldEnd)
+                        {
+                            ParseFloat(pFieldBegin, pFieldEnd, pOut[nIndex]);
+                        });
+}
+
+
+std::size_t DecodeDoubles(const char* pBegin, const char* pEnd, char cDelimiter,
+                          double* pOut, std::size_t nMax)
+{
+    return ForEachField(pBegin, pEnd, cDelimiter, nMax,
+                        [pOut](std::size_t nIndex, const char* pFieldBegin, const char* pFieldEnd)
+                        {
+                            ParseDouble(pFieldBegin, pFieldEnd, pOut[nIndex]);
+                        });
+}
+
+
+std::size_t DecodeInt64s(const char* pBegin, const char* pEnd, char cDelimiter,
+                         std::int64_t* pOut, std::size_t nMax)
+{
+    return ForEachField(pBegin, pEnd, cDelimiter, nMax,
+                        [pOut](std::size_t nIndex, const char* pFieldBegin, const char* pFieldEnd)
+                        {
+                            ParseInt64(pFieldBegin, pFieldEnd, pOut[nIndex]);
+                        });
+}
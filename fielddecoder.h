@@ -0,0 +1,82 @@
+#ifndef FIELDDECODER_H
+#define FIELDDECODER_H
+
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#define FIELDDECODER_SSE2
+#endif
+
+
+/* Allocation free decoding of delimited ASCII numbers.
+ * The single value parsers read a number from a character range that does
+ * not have to be null terminated and return the position behind the last
+ * consumed character. ParseFloat rounds like strtof, ParseInt64 saturates
+ * at the int64 limits. The batch decoders split a whole row on the delimiter
+ * (using SSE2 where available) and decode every field in the same pass;
+ * they follow std::getline rules, so a trailing delimiter does not produce
+ * an empty field. Fields beyond nMax are not decoded, the return value is
+ * the number of values written. */
+
+const char* ParseFloat(const char* pBegin, const char* pEnd, float& fValue);
+const char* ParseDouble(const char* pBegin, const char* pEnd, double& fValue);
+const char* ParseInt64(const char* pBegin, const char* pEnd, std::int64_t& nValue);
+
+const char* FindDelimiter(const char* pBegin, const char* pEnd, char cDelimiter);
+
+std::size_t DecodeFloats(const char* pBegin, const char* pEnd, char cDelimiter,
+                         float* pOut, std::size_t nMax);
+std::size_t DecodeDoubles(const char* pBegin, const char* pEnd, char cDelimiter,
+                          double* pOut, std::size_t nMax);
+std::size_t DecodeInt64s(const char* pBegin, const char* pEnd, char cDelimiter,
+                         std::int64_t* pOut, std::size_t nMax);
+
+
+/* Calls oField(nIndex, pFieldBegin, pFieldEnd) for the first nMax fields of
+ * the row and returns how many there were. Fields that are not needed can
+ * simply be ignored by the callback, they cost only the delimiter scan. */
+template<class F>
+std::size_t ForEachField(const char* pBegin, const char* pEnd, char cDelimiter,
+                         std::size_t nMax, F oField)
+{
+    std::size_t nCount = 0;
+    const char* pField = pBegin;
+    const char* p = pBegin;
+
+#ifdef FIELDDECODER_SSE2
+    // one compare per 16 bytes, then walk the set bits of the mask
+    const __m128i vDelimiter = _mm_set1_epi8(cDelimiter);
+    for (; p + 16 <= pEnd && nCount < nMax; p += 16)
+    {
+        __m128i vBlock = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned nMask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(vBlock, vDelimiter)));
+        while (nMask && nCount < nMax)
+        {
+            const char* pDelimiter = p + __builtin_ctz(nMask);
+            oField(nCount++, pField, pDelimiter);
+            pField = pDelimiter + 1;
+            nMask &= nMask - 1;
+        }
+    }
+#endif
+
+    for (; p < pEnd && nCount < nMax; ++p)
+    {
+        if (*p == cDelimiter)
+        {
+            oField(nCount++, pField, p);
+            pField = p + 1;
+        }
+    }
+
+    if (pField < pEnd && nCount < nMax)
+    {
+        oField(nCount++, pField, pEnd);
+    }
+
+    return nCount;
+}
+
+#endif // FIELDDECODER_H
@@ -0,0 +1,175 @@
+#include "framearena.h"
+
+#include <algorithm>
+
+
+const std::size_t cFrameArena::nColumns;
+const std::size_t cFrameArena::nChunkShift;
+const std::size_t cFrameArena::nChunkFrames;
+
+
+cFrameArena::cFrameArena() :
+    m_nSize(0)
+{
+}
+
+
+std::size_t cFrameArena::Size() const
+{
+    return m_nSize;
+}
+
+
+bool cFrameArena::Empty() const
+{
+    return m_nSize == 0;
+}
+
+
+void cFrameArena::Clear()
+{
+    m_nSize = 0;
+}
+
+
+std::size_t cFrameArena::PushBack(std::int64_t nTime, const float* pPositions)
+{
+    std::size_t nChunk = m_nSize >> nChunkShift;
+    std::size_t nOffset = m_nSize & (nChunkFrames - 1);
+    if (nChunk == m_vecChunks.size())
+    {
+        m_vecChunks.push_back(std::unique_ptr<sChunk>(new sChunk));
+    }
+
+    sChunk& oChunk = *m_vecChunks[nChunk];
+    for (std::size_t nColumn=0; nColumn<nColumns; ++nColumn)
+    {
+        oChunk.aData[nColumn * nChunkFrames + nOffset] = pPositions[nColumn];
+    }
+    oChunk.aTime[nOffset] = nTime;
+
+    return m_nSize++;
+}
+
+
+void cFrameArena::PopBack()
+{
+    if (m_nSize > 0)
+    {
+        --m_nSize;
+    }
+}
+
+
+std::int64_t cFrameArena::Time(std::size_t nFrame) const
+{
+    return m_vecChunks[nFrame >> nChunkShift]->aTime[nFrame & (nChunkFrames - 1)];
+}
+
+
+std::size_t cFrameArena::LowerBound(std::int64_t nTime, std::size_t nFirst) const
+{
+    return Bound(nTime, nFirst, false);
+}
+
+
+std::size_t cFrameArena::UpperBound(std::int64_t nTime, std::size_t nFirst) const
+{
+    return Bound(nTime, nFirst, true);
+}
+
+
+std::size_t cFrameArena::Bound(std::int64_t nTime, std::size_t nFirst, bool bUpper) const
+{
+    auto oBefore = [=](std::int64_t nFrameTime)
+    {
+        return bUpper ? nFrameTime <= nTime : nFrameTime < nTime;
+    };
+
+    if (nFirst >= m_nSize)
+    {
+        return m_nSize;
+    }
+
+    // the bound lies in the first chunk whose last frame is not before it
+    std::size_t nLow = nFirst >> nChunkShift;
+    std::size_t nHigh = ChunkCount();
+    while (nLow < nHigh)
+    {
+        std::size_t nMiddle = nLow + (nHigh - nLow) / 2;
+        if (oBefore(ChunkTimes(nMiddle)[ChunkSize(nMiddle) - 1]))
+        {
+            nLow = nMiddle + 1;
+        }
+        else
+        {
+            nHigh = nMiddle;
+        }
+    }
+    if (nLow == ChunkCount())
+    {
+        return m_nSize;
+    }
+
+    std::size_t nChunkFirst = nLow << nChunkShift;
+    std::size_t nOffset = (nFirst > nChunkFirst) ? nFirst - nChunkFirst : 0;
+    const std::int64_t* pTimes = ChunkTimes(nLow);
+    return nChunkFirst + (std::partition_point(pTimes + nOffset, pTimes + ChunkSize(nLow), oBefore) - pTimes);
+}
+
+
+float cFrameArena::Value(std::size_t nColumn, std::size_t nFrame) const
+{
+    return m_vecChunks[nFrame >> nChunkShift]->aData[nColumn * nChunkFrames + (nFrame & (nChunkFrames - 1))];
+}
+
+
+cVector3<float> cFrameArena::GetPosition(eJointType eType, std::size_t nFrame) const
+{
+    std::size_t nColumn = static_cast<std::size_t>(eType) * 3;
+    return cVector3<float>(Value(nColumn, nFrame), Value(nColumn + 1, nFrame), Value(nColumn + 2, nFrame));
+}
+
+
+std::size_t cFrameArena::ChunkCount() const
+{
+    return (m_nSize + nChunkFrames - 1) >> nChunkShift;
+}
+
+
+std::size_t cFrameArena::ChunkSize(std::size_t nChunk) const
+{
+    std::size_t nFirst = nChunk << nChunkShift;
+    return (m_nSize - nFirst < nChunkFrames) ? m_nSize - nFirst : nChunkFrames;
+}
+
+
+const float* cFrameArena::ChunkColumn(std::size_t nChunk, std::size_t nColumn) const
+{
+    return m_vecChunks[nChunk]->aData + nColumn * nChunkFrames;
+}
+
+
+const std::int64_t* cFrameArena::ChunkTimes(std::size_t nChunk) const
+{
+    return m_vecChunks[nChunk]->aTime;
+}
+
+
+void cFrameArena::CopyTo(cSkeletonFrames& oFrames) const
+{
+    oFrames.Clear();
+    oFrames.Resize(m_nSize);
+
+    for (std::size_t nChunk=0; nChunk<ChunkCount(); ++nChunk)
+    {
+        std::size_t nFirst = nChunk << nChunkShift;
+        std::size_t nCount = ChunkSize(nChunk);
+        for (std::size_t nColumn=0; nColumn<nColumns; ++nColumn)
+        {
+            std::copy(ChunkColumn(nChunk, nColumn), ChunkColumn(nChunk, nColumn) + nCount,
+                      oFrames.Column(nColumn) + nFirst);
+        }
+        std::copy(ChunkTimes(nChunk), ChunkTimes(nChunk) + nCount, &oFrames.Time(nFirst));
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef CFRAMEARENA_H
+#define CFRAMEARENA_H
+
+#include "skeletonframes.h"
+#include "joint.h"
+#include "vector3.hpp"
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+
+/* Append-only frame storage made of fixed size chunks. Every chunk holds
+ * nChunkFrames frames in the column layout of cSkeletonFrames, so scans
+ * within a chunk stay linear, but growing never moves frames that are
+ * already stored. Chunks are only released by the destructor: Clear and
+ * PopBack keep them for the next frames, so a motion that is loaded over
+ * and over performs one allocation per chunk. */
+class cFrameArena
+{
+public:
+  static const std::size_t nColumns = cSkeletonFrames::nColumns;
+  static const std::size_t nChunkShift = 12;
+  static const std::size_t nChunkFrames = static_cast<std::size_t>(1) << nChunkShift;
+
+  cFrameArena();
+
+  std::size_t Size() const;
+  bool Empty() const;
+  void Clear();
+
+  // appends a frame of nColumns values (x/y/z per joint in eJointType order)
+  std::size_t PushBack(std::int64_t nTime, const float* pPositions);
+  void PopBack();
+
+  std::int64_t Time(std::size_t nFrame) const;
+  // binary search over the frames [nFirst, Size()), which have to be ordered
+  // by time: first frame with a time >= nTime (LowerBound) or > nTime (UpperBound)
+  std::size_t LowerBound(std::int64_t nTime, std::size_t nFirst = 0) const;
+  std::size_t UpperBound(std::int64_t nTime, std::size_t nFirst = 0) const;
+  float Value(std::size_t nColumn, std::size_t nFrame) const;
+  cVector3<float> GetPosition(eJointType eType, std::size_t nFrame) const;
+
+  // chunk wise access for linear scans, chunk n holds frames
+  // [n * nChunkFrames, n * nChunkFrames + ChunkSize(n))
+  std::size_t ChunkCount() const;
+  std::size_t ChunkSize(std::size_t nChunk) const;
+  const float* ChunkColumn(std::size_t nChunk, std::size_t nColumn) const;
+  const std::int64_t* ChunkTimes(std::size_t nChunk) const;
+
+  void CopyTo(cSkeletonFrames& oFrames) const;
+
+private:
+  struct sChunk
+  {
+    float aData[nColumns * nChunkFrames];
+    std::int64_t aTime[nChunkFrames];
+  };
+
+  // the chunks in use come first, the rest are kept for reuse
+  std::vector<std::unique_ptr<sChunk>> m_vecChunks;
+  std::size_t m_nSize;
+
+  std::size_t Bound(std::int64_t nTime, std::size_t nFirst, bool bUpper) const;
+};
+
+#endif // CFRAMEARENA_H
@@ -0,0 +1,94 @@
+#include "framefilter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+
+namespace
+{
+    const float fTwoPi = 6.28318530718f;
+
+    // smoothing factor of an exponential low pass with the given cutoff
+    inline float Alpha(float fCutoff, float fSeconds)
+    {
+        float fRate = fTwoPi * fCutoff * fSeconds;
+        return fRate / (fRate + 1.0f);
+    }
+}
+
+
+const std::size_t cOneEuroFilter::nColumns;
+const std::size_t cOneEuroFilter::nPaddedColumns;
+
+
+cOneEuroFilter::cOneEuroFilter(float fMinCutoff, float fBeta, float fDerivativeCutoff) :
+    m_fMinCutoff(fMinCutoff),
+    m_fBeta(fBeta),
+    m_fDerivativeCutoff(fDerivativeCutoff)
+{
+    Reset();
+}
+
+
+void cOneEuroFilter::Reset()
+{
+    m_bFirst = true;
+    for (std::size_t nColumn=0; nColumn<nPaddedColumns; ++nColumn)
+    {
+        m_aValue[nColumn] = 0.0f;
+        m_aDerivative[nColumn] = 0.0f;
+    }
+}
+
+
+void cOneEuroFilter::Filter(double fSeconds, const float* pIn, float* pOut)
+{
+    if (m_bFirst)
+    {
+        for (std::size_t nColumn=0; nColumn<nColumns; ++nColumn)
+        {
+            m_aValue[nColumn] = pIn[nColumn];
+            pOut[nColumn] = pIn[nColumn];
+        }
+        m_bFirst = false;
+        return;
+    }
+
+    // a repeated timestamp carries no new information
+    if (fSeconds <= 0.0)
+    {
+        for (std::size_t nColumn=0; nColumn<nColumns; ++nColumn)
+        {
+            pOut[nColumn] = m_aValue[nColumn];
+        }
+        return;
+    }
+
+    // a local copy of the input tells the compiler nothing aliases the state
+    float aIn[nPaddedColumns] = {};
+    std::copy(pIn, pIn + nColumns, aIn);
+
+    float fDt = static_cast<float>(fSeconds);
+    float fInverseDt = 1.0f / fDt;
+    float fDerivativeAlpha = Alpha(m_fDerivativeCutoff, fDt);
+    float fRateScale = fTwoPi * fDt;
+    for (std::size_t nColumn=0; nColumn<nPaddedColumns; ++nColumn)
+    {
+        float fSpeed = (aIn[nColumn] - m_aValue[nColumn]) * fInverseDt;
+        m_aDerivative[nColumn] += fDerivativeAlpha * (fSpeed - m_aDerivative[nColumn]);
+
+        float fRate = fRateScale * (m_fMinCutoff + m_fBeta * std::fabs(m_aDerivative[nColumn]));
+        m_aValue[nColumn] += fRate / (fRate + 1.0f) * (aIn[nColumn] - m_aValue[nColumn]);
+    }
+
+    std::copy(m_aValue, m_aValue + nColumns, pOut);
+}
+
+
+std::string cOneEuroFilter::Describe() const
+{
+    std::ostringstream oStream;
+    oStream << "one euro " << m_fMinCutoff << " " << m_fBeta << " " << m_fDerivativeCutoff;
+    return oStream.str();
+}
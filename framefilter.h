@@ -0,0 +1,55 @@
+#ifndef CFRAMEFILTER_H
+#define CFRAMEFILTER_H
+
+#include "skeletonframes.h"
+
+#include <string>
+
+
+/* Streaming filter stage between the validation and the storage of a
+ * motion. It sees every accepted frame once and in time order and keeps a
+ * constant amount of state, so a whole recording and a live feed go through
+ * the same code and nothing downstream needs a second pass. */
+class cFrameFilter
+{
+public:
+  virtual ~cFrameFilter() {}
+
+  virtual void Reset() = 0;
+  // fSeconds since the previous frame, 0 for the first one; pIn and pOut hold
+  // cSkeletonFrames::nColumns values and may be the same
+  virtual void Filter(double fSeconds, const float* pIn, float* pOut) = 0;
+  // the settings in text form, a cache built with other settings is not used
+  virtual std::string Describe() const = 0;
+};
+
+
+/* One euro filter (Casiez, Roussel and Vogel, 2012) on every coordinate: a
+ * low pass whose cutoff frequency rises with the speed, so jitter at rest is
+ * smoothed strongly while fast moves lag little. fMinCutoff is in Hz, fBeta
+ * in Hz per m/s. All columns are updated in one branch free loop, which the
+ * compiler vectorizes. */
+class cOneEuroFilter : public cFrameFilter
+{
+public:
+  cOneEuroFilter(float fMinCutoff = 1.5f, float fBeta = 2.0f, float fDerivativeCutoff = 1.0f);
+
+  void Reset() override;
+  void Filter(double fSeconds, const float* pIn, float* pOut) override;
+  std::string Describe() const override;
+
+private:
+  static const std::size_t nColumns = cSkeletonFrames::nColumns;
+  // the state is padded to whole SSE registers, a loop with a remainder is not vectorized at -O2
+  static const std::size_t nPaddedColumns = (nColumns + 3) & ~static_cast<std::size_t>(3);
+
+  float m_fMinCutoff;
+  float m_fBeta;
+  float m_fDerivativeCutoff;
+
+  bool m_bFirst;
+  float m_aValue[nPaddedColumns];
+  float m_aDerivative[nPaddedColumns];
+};
+
+#endif // CFRAMEFILTER_H
@@ -0,0 +1,75 @@
+#include "framering.h"
+
+#include <chrono>
+
+
+cFrameRing::cFrameRing(std::size_t nCapacity) :
+    m_nMask(0),
+    m_nHead(0),
+    m_nTail(0),
+    m_nDropped(0)
+{
+    std::size_t nSize = 1;
+    while (nSize < nCapacity)
+    {
+        nSize <<= 1;
+    }
+    m_vecSlots.resize(nSize);
+    m_nMask = nSize - 1;
+}
+
+
+std::size_t cFrameRing::Capacity() const
+{
+    return m_vecSlots.size();
+}
+
+
+std::size_t cFrameRing::Size() const
+{
+    return m_nTail.load(std::memory_order_acquire) - m_nHead.load(std::memory_order_acquire);
+}
+
+
+std::size_t cFrameRing::Dropped() const
+{
+    return m_nDropped.load(std::memory_order_relaxed);
+}
+
+
+bool cFrameRing::Push(const sFrame& oFrame)
+{
+    // the tail is only written here, the head is released by Pop after the slot was read
+    std::size_t nTail = m_nTail.load(std::memory_order_relaxed);
+    if (nTail - m_nHead.load(std::memory_order_acquire) == m_vecSlots.size())
+    {
+        m_nDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    m_vecSlots[nTail & m_nMask] = oFrame;
+    m_nTail.store(nTail + 1, std::memory_order_release);
+    return true;
+}
+
+
+bool cFrameRing::Pop(sFrame& oFrame)
+{
+    std::size_t nHead = m_nHead.load(std::memory_order_relaxed);
+    if (nHead == m_nTail.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    oFrame = m_vecSlots[nHead & m_nMask];
+    m_nHead.store(nHead + 1, std::memory_order_release);
+    return true;
+}
+
+
+std::int64_t cFrameRing::Now()
+{
+    // steady_clock is CLOCK_MONOTONIC on Linux, which all processes share
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
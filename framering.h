@@ -0,0 +1,55 @@
+#ifndef CFRAMERING_H
+#define CFRAMERING_H
+
+#include "skeletonframes.h"
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+
+/* Lock-free queue of skeleton frames between exactly one producer thread
+ * (e.g. a socket receiver) and one consumer thread. The slots are allocated
+ * once, Push and Pop copy one frame and touch no lock and no allocator.
+ * A full ring drops the new frame: for live data the consumer is better off
+ * skipping a frame than the receiver blocking on it. */
+class cFrameRing
+{
+public:
+  struct sFrame
+  {
+    std::int64_t nTime;
+    // steady clock in ns (cFrameRing::Now) at which the frame left its source
+    std::int64_t nStamp;
+    float aPositions[cSkeletonFrames::nColumns];
+  };
+
+  // the capacity is rounded up to a power of two
+  cFrameRing(std::size_t nCapacity = 256);
+
+  std::size_t Capacity() const;
+  // frames waiting, exact only on the consumer thread
+  std::size_t Size() const;
+  // frames the producer could not queue since construction
+  std::size_t Dropped() const;
+
+  // producer thread only
+  bool Push(const sFrame& oFrame);
+  // consumer thread only
+  bool Pop(sFrame& oFrame);
+
+  // monotonic clock in ns, comparable between processes on one host
+  static std::int64_t Now();
+
+private:
+  std::vector<sFrame> m_vecSlots;
+  std::size_t m_nMask;
+
+  // written by one side each, kept on separate cache lines
+  alignas(64) std::atomic<std::size_t> m_nHead;
+  alignas(64) std::atomic<std::size_t> m_nTail;
+  std::atomic<std::size_t> m_nDropped;
+};
+
+#endif // CFRAMERING_H
@@ -0,0 +1,192 @@
+#include "framevalidator.h"
+#include "helper.h"
+
+
+namespace
+{
+    // thresholds of a collapsed skeleton, see cHierarchicMotion::Zero
+    const float fZeroSizeX = 0.1f;
+    const float fZeroSizeY = 0.01f;
+    const float fZeroSizeZ = 0.1f;
+
+    const unsigned aBitCount[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+}
+
+
+cFrameValidator::cFrameValidator() :
+    m_fTolerance(0.3f)
+{
+}
+
+
+void cFrameValidator::SetLimbLengths(const float* pLimbLengths, float fTolerance)
+{
+    m_vecBones.clear();
+    for (const sBone& oBone : aBones)
+    {
+        if (aLimbChecked[oBone.eChild])
+        {
+            sCheckedBone oChecked;
+            oChecked.nParentColumn = static_cast<std::size_t>(oBone.eParent) * 3;
+            oChecked.nChildColumn = static_cast<std::size_t>(oBone.eChild) * 3;
+            oChecked.eChild = oBone.eChild;
+            oChecked.fLimbLength = static_cast<double>(pLimbLengths[oBone.eChild]);
+            m_vecBones.push_back(oChecked);
+        }
+    }
+    m_fTolerance = static_cast<double>(fTolerance);
+}
+
+
+bool cFrameValidator::IsAccepted(const std::vector<std::uint64_t>& vecAccepted, std::size_t nIndex)
+{
+    return (vecAccepted[nIndex >> 6] >> (nIndex & 63)) & 1;
+}
+
+
+std::size_t cFrameValidator::Validate(const cSkeletonFrames& oFrames, std::size_t nFirst, std::size_t nCount,
+                                      std::vector<std::uint64_t>& vecAccepted) const
+{
+    vecAccepted.assign((nCount + 63) / 64, 0);
+    std::size_t nAccepted = 0;
+    std::size_t i = 0;
+
+#ifdef FRAMEVALIDATOR_SSE2
+    // groups of four never straddle a mask word
+    for (; i + 4 <= nCount; i += 4)
+    {
+        unsigned nBits = ValidateFour(oFrames, nFirst + i);
+        vecAccepted[i >> 6] |= static_cast<std::uint64_t>(nBits) << (i & 63);
+        nAccepted += aBitCount[nBits];
+    }
+#endif
+
+    eJointType eBone;
+    double fDeviation;
+    for (; i < nCount; ++i)
+    {
+        if (Check(oFrames, nFirst + i, eBone, fDeviation) == FV_ACCEPTED)
+        {
+            vecAccepted[i >> 6] |= static_cast<std::uint64_t>(1) << (i & 63);
+            ++nAccepted;
+        }
+    }
+
+    return nAccepted;
+}
+
+
+double cFrameValidator::Deviation(double fLimbLength, double fLength)
+{
+    return fabs((fLimbLength - fLength) / ((fLimbLength + fLength) / 2.0f));
+}
+
+
+cFrameValidator::eVerdict cFrameValidator::Check(const cSkeletonFrames& oFrames, std::size_t nFrame,
+                                                 eJointType& eBone, double& fDeviation) const
+{
+    if (IsZero(oFrames, nFrame))
+    {
+        return FV_COLLAPSED;
+    }
+
+    for (const sCheckedBone& oBone : m_vecBones)
+    {
+        cVector3<float> oOffset(oFrames.Column(oBone.nParentColumn)[nFrame] - oFrames.Column(oBone.nChildColumn)[nFrame],
+                                oFrames.Column(oBone.nParentColumn + 1)[nFrame] - oFrames.Column(oBone.nChildColumn + 1)[nFrame],
+                                oFrames.Column(oBone.nParentColumn + 2)[nFrame] - oFrames.Column(oBone.nChildColumn + 2)[nFrame]);
+
+        if (!EQPercentageDiff(oBone.fLimbLength, static_cast<double>(oOffset.Magnitude()), m_fTolerance))
+        {
+            eBone = oBone.eChild;
+            fDeviation = Deviation(oBone.fLimbLength, static_cast<double>(oOffset.Magnitude()));
+            return FV_LIMB_MISMATCH;
+        }
+    }
+    return FV_ACCEPTED;
+}
+
+
+bool cFrameValidator::IsZero(const cSkeletonFrames& oFrames, std::size_t nFrame) const
+{
+    float fMaxX = -100, fMinX = 100, fMaxY = -100, fMinY = 100, fMaxZ = -100, fMinZ = 100;
+
+    for (int i=0; i<JT_Count; ++i)
+    {
+        float fCurX = oFrames.Column(i * 3)[nFrame];
+        float fCurY = oFrames.Column(i * 3 + 1)[nFrame];
+        float fCurZ = oFrames.Column(i * 3 + 2)[nFrame];
+
+        fMinX = (fCurX < fMinX) ? fCurX : fMinX;
+        fMinY = (fCurY < fMinY) ? fCurY : fMinY;
+        fMinZ = (fCurZ < fMinZ) ? fCurZ : fMinZ;
+
+        fMaxX = (fCurX > fMaxX) ? fCurX : fMaxX;
+        fMaxY = (fCurY > fMaxY) ? fCurY : fMaxY;
+        fMaxZ = (fCurZ > fMaxZ) ? fCurZ : fMaxZ;
+    }
+
+    return (fabs(fMaxX - fMinX) < fZeroSizeX) && (fabs(fMaxY - fMinY) < fZeroSizeY)
+        && (fabs(fMaxZ - fMinZ) < fZeroSizeZ);
+}
+
+
+#ifdef FRAMEVALIDATOR_SSE2
+unsigned cFrameValidator::ValidateFour(const cSkeletonFrames& oFrames, std::size_t nFrame) const
+{
+    // bounding box of the skeleton, min/max keep the old value for NaN like the scalar code
+    __m128 vMinX = _mm_set1_ps(100.0f), vMinY = vMinX, vMinZ = vMinX;
+    __m128 vMaxX = _mm_set1_ps(-100.0f), vMaxY = vMaxX, vMaxZ = vMaxX;
+    for (int i=0; i<JT_Count; ++i)
+    {
+        __m128 vX = _mm_loadu_ps(oFrames.Column(i * 3) + nFrame);
+        __m128 vY = _mm_loadu_ps(oFrames.Column(i * 3 + 1) + nFrame);
+        __m128 vZ = _mm_loadu_ps(oFrames.Column(i * 3 + 2) + nFrame);
+        vMinX = _mm_min_ps(vX, vMinX);
+        vMinY = _mm_min_ps(vY, vMinY);
+        vMinZ = _mm_min_ps(vZ, vMinZ);
+        vMaxX = _mm_max_ps(vX, vMaxX);
+        vMaxY = _mm_max_ps(vY, vMaxY);
+        vMaxZ = _mm_max_ps(vZ, vMaxZ);
+    }
+
+    const __m128 vSignF = _mm_set1_ps(-0.0f);
+    __m128 vZero = _mm_and_ps(_mm_cmplt_ps(_mm_andnot_ps(vSignF, _mm_sub_ps(vMaxX, vMinX)), _mm_set1_ps(fZeroSizeX)),
+                              _mm_cmplt_ps(_mm_andnot_ps(vSignF, _mm_sub_ps(vMaxY, vMinY)), _mm_set1_ps(fZeroSizeY)));
+    vZero = _mm_and_ps(vZero, _mm_cmplt_ps(_mm_andnot_ps(vSignF, _mm_sub_ps(vMaxZ, vMinZ)), _mm_set1_ps(fZeroSizeZ)));
+    unsigned nAccepted = ~static_cast<unsigned>(_mm_movemask_ps(vZero)) & 15u;
+
+    // bone lengths in float like cVector3<float>::Magnitude, the comparison in
+    // double like EQPercentageDiff
+    const __m128d vSignD = _mm_set1_pd(-0.0);
+    const __m128d vTwo = _mm_set1_pd(2.0);
+    const __m128d vTolerance = _mm_set1_pd(m_fTolerance);
+    for (std::size_t nBone=0; nBone<m_vecBones.size() && nAccepted; ++nBone)
+    {
+        const sCheckedBone& oBone = m_vecBones[nBone];
+        __m128 vDX = _mm_sub_ps(_mm_loadu_ps(oFrames.Column(oBone.nParentColumn) + nFrame),
+                                _mm_loadu_ps(oFrames.Column(oBone.nChildColumn) + nFrame));
+        __m128 vDY = _mm_sub_ps(_mm_loadu_ps(oFrames.Column(oBone.nParentColumn + 1) + nFrame),
+                                _mm_loadu_ps(oFrames.Column(oBone.nChildColumn + 1) + nFrame));
+        __m128 vDZ = _mm_sub_ps(_mm_loadu_ps(oFrames.Column(oBone.nParentColumn + 2) + nFrame),
+                                _mm_loadu_ps(oFrames.Column(oBone.nChildColumn + 2) + nFrame));
+        __m128 vLength = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vDX, vDX), _mm_mul_ps(vDY, vDY)),
+                                                _mm_mul_ps(vDZ, vDZ)));
+
+        const __m128d vLimb = _mm_set1_pd(oBone.fLimbLength);
+        __m128d aLengths[2] = {_mm_cvtps_pd(vLength), _mm_cvtps_pd(_mm_movehl_ps(vLength, vLength))};
+        unsigned nFit = 0;
+        for (int nHalf=0; nHalf<2; ++nHalf)
+        {
+            __m128d vRatio = _mm_div_pd(_mm_sub_pd(vLimb, aLengths[nHalf]),
+                                        _mm_div_pd(_mm_add_pd(vLimb, aLengths[nHalf]), vTwo));
+            // NaN (both lengths 0) compares false and rejects, as in the scalar code
+            __m128d vFit = _mm_cmplt_pd(_mm_andnot_pd(vSignD, vRatio), vTolerance);
+            nFit |= static_cast<unsigned>(_mm_movemask_pd(vFit)) << (2 * nHalf);
+        }
+        nAccepted &= nFit;
+    }
+
+    return nAccepted;
+}
+#endif
@@ -0,0 +1,72 @@
+#ifndef CFRAMEVALIDATOR_H
+#define CFRAMEVALIDATOR_H
+
+#include "skeletonframes.h"
+#include "skeletontopology.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#define FRAMEVALIDATOR_SSE2
+#endif
+
+
+/* Checks many frames at once against calibrated limb lengths. A frame is
+ * rejected if the skeleton has collapsed to (almost) a point, which is how
+ * the sensor reports a lost body, or if one of the checked bones (see
+ * aLimbChecked) differs from its calibrated length by more than the relative
+ * tolerance. The frames are read column wise and four of them are validated
+ * per SSE2 instruction; the verdicts are the same as checking every frame
+ * with cVector3::Magnitude and EQPercentageDiff. */
+class cFrameValidator
+{
+public:
+  enum eVerdict
+  {
+    FV_ACCEPTED = 0,
+    FV_COLLAPSED,
+    FV_LIMB_MISMATCH
+  };
+
+  cFrameValidator();
+
+  // pLimbLengths per joint type, as returned by cHierarchicMotion::GetLimbLength
+  void SetLimbLengths(const float* pLimbLengths, float fTolerance = 0.3f);
+
+  // bit i of word i / 64 is set if frame nFirst + i is accepted, returns the number of accepted frames
+  std::size_t Validate(const cSkeletonFrames& oFrames, std::size_t nFirst, std::size_t nCount,
+                       std::vector<std::uint64_t>& vecAccepted) const;
+
+  static bool IsAccepted(const std::vector<std::uint64_t>& vecAccepted, std::size_t nIndex);
+
+  // scalar check of one frame that also tells why it fails: for FV_LIMB_MISMATCH
+  // the first bone (in aBones order) that does not fit and its relative deviation
+  eVerdict Check(const cSkeletonFrames& oFrames, std::size_t nFrame, eJointType& eBone, double& fDeviation) const;
+
+  // relative deviation of a measured from a calibrated length, see EQPercentageDiff
+  static double Deviation(double fLimbLength, double fLength);
+
+private:
+  struct sCheckedBone
+  {
+    std::size_t nParentColumn;
+    std::size_t nChildColumn;
+    eJointType eChild;
+    double fLimbLength;
+  };
+
+  std::vector<sCheckedBone> m_vecBones;
+  double m_fTolerance;
+
+  bool IsZero(const cSkeletonFrames& oFrames, std::size_t nFrame) const;
+
+#ifdef FRAMEVALIDATOR_SSE2
+  // accept bits of the four frames starting at nFrame
+  unsigned ValidateFour(const cSkeletonFrames& oFrames, std::size_t nFrame) const;
+#endif
+};
+
+#endif // CFRAMEVALIDATOR_H
@@ -0,0 +1,193 @@
+#include "geotable.h"
+#include "mappedfile.h"
+#include "fielddecoder.h"
+#include "parallel.h"
+
+#include <chrono>
+#include <cstring>
+
+
+namespace
+{
+    const std::size_t nValueColumns = 5;
+
+
+    const char* NextLine(const char* pBegin, const char* pEnd)
+    {
+        const char* pNewLine = static_cast<const char*>(memchr(pBegin, '\n', pEnd - pBegin));
+        return pNewLine ? pNewLine + 1 : pEnd;
+    }
+
+
+    std::size_t CountLines(const char* pBegin, const char* pEnd)
+    {
+        std::size_t nLines = 0;
+        for (const char* pCur = pBegin; pCur < pEnd; pCur = NextLine(pCur, pEnd))
+        {
+            ++nLines;
+        }
+        return nLines;
+    }
+
+
+    // moves rows [nFrom, nFrom+nCount) of a column to nTo, the ranges may overlap
+    void MoveRows(std::vector<double>& vecColumn, std::size_t nFrom, std::size_t nCount, std::size_t nTo)
+    {
+        if (nCount > 0 && nFrom != nTo)
+        {
+            memmove(&vecColumn[nTo], &vecColumn[nFrom], nCount * sizeof(double));
+        }
+    }
+}
+
+
+void sGeoTable::Resize(std::size_t nRows)
+{
+    vecLatitude.resize(nRows);
+    vecLongitude.resize(nRows);
+    vecTemperature.resize(nRows);
+    vecRainfall.resize(nRows);
+    vecSunshine.resize(nRows);
+}
+
+
+cGeoTableParser::cGeoTableParser(std::size_t nSkipLines) :
+    m_nSkipLines(nSkipLines),
+    m_nBytes(0),
+    m_fSeconds(0.0)
+{
+}
+
+
+const std::size_t cGeoTableParser::nMinChunkSize;
+
+
+bool cGeoTableParser::LoadFromFile(const std::string& sFilename, sGeoTable& oTable, unsigned nThreads)
+{
+    auto oStart = std::chrono::steady_clock::now();
+
+    cMappedFile oFile;
+    if (!oFile.Open(sFilename))
+    {
+        return false;
+    }
+
+    Parse(oFile.Begin(), oFile.End(), oTable, nThreads);
+
+    // include mapping the file
+    m_fSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - oStart).count();
+    return true;
+}
+
+
+std::size_t cGeoTableParser::Bytes() const
+{
+    return m_nBytes;
+}
+
+
+double cGeoTableParser::Seconds() const
+{
+    return m_fSeconds;
+}
+
+
+std::size_t cGeoTableParser::Parse(const char* pBegin, const char* pEnd, sGeoTable& oTable, unsigned nThreads)
+{
+    auto oStart = std::chrono::steady_clock::now();
+    m_nBytes = static_cast<std::size_t>(pEnd - pBegin);
+
+    for (std::size_t nLine=0; nLine<m_nSkipLines && pBegin < pEnd; ++nLine)
+    {
+        pBegin = NextLine(pBegin, pEnd);
+    }
+
+    nThreads = nThreads ? nThreads : HardwareThreads();
+    std::size_t nChunks = static_cast<std::size_t>(pEnd - pBegin) / nMinChunkSize;
+    nChunks = (nChunks < nThreads) ? nChunks : nThreads;
+    nChunks = nChunks ? nChunks : 1;
+
+    // byte ranges that start right behind a line break
+    std::vector<const char*> vecBounds(nChunks + 1, pEnd);
+    vecBounds[0] = pBegin;
+    for (std::size_t nChunk=1; nChunk<nChunks; ++nChunk)
+    {
+        const char* pSplit = pBegin + (pEnd - pBegin) * nChunk / nChunks;
+        pSplit = (pSplit < vecBounds[nChunk-1]) ? vecBounds[nChunk-1] : pSplit;
+        vecBounds[nChunk] = NextLine(pSplit, pEnd);
+    }
+
+    std::vector<std::size_t> vecLines(nChunks, 0);
+    ParallelFor(0, nChunks, [&](std::size_t nChunk)
+    {
+        vecLines[nChunk] = CountLines(vecBounds[nChunk], vecBounds[nChunk+1]);
+    }, nThreads);
+
+    std::size_t nFirst = oTable.Size();
+    std::vector<std::size_t> vecOffsets(nChunks, nFirst);
+    for (std::size_t nChunk=1; nChunk<nChunks; ++nChunk)
+    {
+        vecOffsets[nChunk] = vecOffsets[nChunk-1] + vecLines[nChunk-1];
+    }
+    oTable.Resize(vecOffsets[nChunks-1] + vecLines[nChunks-1]);
+
+    std::vector<std::size_t> vecParsed(nChunks, 0);
+    ParallelFor(0, nChunks, [&](std::size_t nChunk)
+    {
+        vecParsed[nChunk] = ParseRange(vecBounds[nChunk], vecBounds[nChunk+1], oTable, vecOffsets[nChunk]);
+    }, nThreads);
+
+    // empty lines leave holes at the end of a chunk, close them
+    std::size_t nEnd = nFirst + vecParsed[0];
+    for (std::size_t nChunk=1; nChunk<nChunks; ++nChunk)
+    {
+        MoveRows(oTable.vecLatitude, vecOffsets[nChunk], vecParsed[nChunk], nEnd);
+        MoveRows(oTable.vecLongitude, vecOffsets[nChunk], vecParsed[nChunk], nEnd);
+        MoveRows(oTable.vecTemperature, vecOffsets[nChunk], vecParsed[nChunk], nEnd);
+        MoveRows(oTable.vecRainfall, vecOffsets[nChunk], vecParsed[nChunk], nEnd);
+        MoveRows(oTable.vecSunshine, vecOffsets[nChunk], vecParsed[nChunk], nEnd);
+        nEnd += vecParsed[nChunk];
+    }
+    oTable.Resize(nEnd);
+
+    m_fSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - oStart).count();
+    return nEnd - nFirst;
+}
+
+
+std::size_t cGeoTableParser::ParseRange(const char* pBegin, const char* pEnd, sGeoTable& oTable, std::size_t nFirst)
+{
+    double* aColumns[nValueColumns] = {
+        oTable.vecLatitude.data(), oTable.vecLongitude.data(), oTable.vecTemperature.data(),
+        oTable.vecRainfall.data(), oTable.vecSunshine.data()
+    };
+
+    std::size_t nRow = nFirst;
+    for (const char* pCur = pBegin; pCur < pEnd; )
+    {
+        const char* pNext = NextLine(pCur, pEnd);
+        const char* pLineEnd = pNext;
+        while (pLineEnd > pCur && (pLineEnd[-1] == '\n' || pLineEnd[-1] == '\r'
+                                   || pLineEnd[-1] == ' ' || pLineEnd[-1] == '\t'))
+        {
+            --pLineEnd;
+        }
+
+        if (pLineEnd > pCur)
+        {
+            // the first non numeric field (the station name) ends the row
+            const char* p = pCur;
+            for (std::size_t nColumn=0; nColumn<nValueColumns; ++nColumn)
+            {
+                double fValue = 0.0;
+                const char* pValueEnd = ParseDouble(p, pLineEnd, fValue);
+                p = (pValueEnd == p) ? pLineEnd : pValueEnd;
+                aColumns[nColumn][nRow] = fValue;
+            }
+            ++nRow;
+        }
+
+        pCur = pNext;
+    }
+    return nRow - nFirst;
+}
@@ -0,0 +1,53 @@
+#ifndef CGEOTABLE_H
+#define CGEOTABLE_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+
+// one column per quantity, row i is the i-th station of the file
+struct sGeoTable
+{
+  std::vector<double> vecLatitude;
+  std::vector<double> vecLongitude;
+  std::vector<double> vecTemperature;
+  std::vector<double> vecRainfall;
+  std::vector<double> vecSunshine;
+
+  std::size_t Size() const { return vecLatitude.size(); }
+  void Resize(std::size_t nRows);
+};
+
+
+/* Bulk parser for the GeoData tables read by Load/GeoData
+ * (latitude longitude temperature rainfall sunshine [name], separated by
+ * blanks or tabs, nSkipLines comment lines at the top). The file is memory
+ * mapped, the columns are sized once from a line count and the numbers are
+ * decoded in place, optionally in newline aligned chunks on several threads.
+ * Missing values are 0, empty lines are skipped. */
+class cGeoTableParser
+{
+public:
+  cGeoTableParser(std::size_t nSkipLines = 2);
+
+  // nThreads == 1 parses on the calling thread, 0 uses all cores
+  bool LoadFromFile(const std::string& sFilename, sGeoTable& oTable, unsigned nThreads = 1);
+  std::size_t Parse(const char* pBegin, const char* pEnd, sGeoTable& oTable, unsigned nThreads = 1);
+
+  // input size and wall time of the last LoadFromFile/Parse
+  std::size_t Bytes() const;
+  double Seconds() const;
+
+private:
+  std::size_t m_nSkipLines;
+  std::size_t m_nBytes;
+  double m_fSeconds;
+
+  // below this size the thread start up costs more than it saves
+  static const std::size_t nMinChunkSize = 1 << 20;
+
+  std::size_t ParseRange(const char* pBegin, const char* pEnd, sGeoTable& oTable, std::size_t nFirst);
+};
+
+#endif // CGEOTABLE_H
@@ -0,0 +1,882 @@
+#include "gzipreader.h"
+#include "mappedfile.h"
+#include "helper.h"
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <exception>
+
+
+/* lodepng (lodepng.cpp) only inflates a complete buffer into one growing
+ * vector, which rules out overlapping decompression with parsing. The
+ * inflater below follows the same block structure (stored, fixed and dynamic
+ * Huffman blocks, RFC 1951) but writes into a sliding 32 KiB window and
+ * flushes every full chunk to the consumer. */
+namespace
+{
+    const unsigned short aLengthBase[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+    };
+    const unsigned char aLengthExtra[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+    };
+    const unsigned short aDistanceBase[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+    };
+    const unsigned char aDistanceExtra[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+    };
+    const unsigned char aCodeLengthOrder[19] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+    };
+
+    const std::size_t nWindowSize = 32768;
+
+
+    class cCRC32
+    {
+    public:
+        cCRC32() : m_nValue(0xffffffffu)
+        {
+            static bool bInit = InitTable();
+            (void)bInit;
+        }
+
+        void Update(const unsigned char* pData, std::size_t nSize)
+        {
+            std::uint32_t nValue = m_nValue;
+            for (std::size_t i=0; i<nSize; ++i)
+            {
+                nValue = aTable()[(nValue ^ pData[i]) & 0xff] ^ (nValue >> 8);
+            }
+            m_nValue = nValue;
+        }
+
+        std::uint32_t Value() const { return m_nValue ^ 0xffffffffu; }
+
+    private:
+        std::uint32_t m_nValue;
+
+        static std::uint32_t* aTable()
+        {
+            static std::uint32_t aCRCTable[256];
+            return aCRCTable;
+        }
+
+        static bool InitTable()
+        {
+            for (std::uint32_t n=0; n<256; ++n)
+            {
+                std::uint32_t c = n;
+                for (int k=0; k<8; ++k)
+                {
+                    c = (c & 1) ? 0xedb88320u ^ (c >> 1) : (c >> 1);
+                }
+                aTable()[n] = c;
+            }
+            return true;
+        }
+    };
+
+
+    class cAdler32
+    {
+    public:
+        cAdler32() : m_nA(1), m_nB(0) { }
+
+        void Update(const unsigned char* pData, std::size_t nSize)
+        {
+            while (nSize > 0)
+            {
+                // largest block that can not overflow the 32 bit sums
+                std::size_t nBlock = (nSize < 5552) ? nSize : 5552;
+                for (std::size_t i=0; i<nBlock; ++i)
+                {
+                    m_nA += pData[i];
+                    m_nB += m_nA;
+                }
+                m_nA %= 65521;
+                m_nB %= 65521;
+                pData += nBlock;
+                nSize -= nBlock;
+            }
+        }
+
+        std::uint32_t Value() const { return (m_nB << 16) | m_nA; }
+
+    private:
+        std::uint32_t m_nA;
+        std::uint32_t m_nB;
+    };
+
+
+    // LSB first bit reader over the mapped input, reads zeros past the end
+    class cBitReader
+    {
+    public:
+        cBitReader(const unsigned char* pBegin, const unsigned char* pEnd) :
+            m_pCur(pBegin), m_pEnd(pEnd), m_nBits(0), m_nCount(0), m_nPadding(0)
+        {
+        }
+
+        unsigned Peek(unsigned nBits)
+        {
+            if (m_nCount < nBits)
+            {
+                Refill();
+            }
+            return static_cast<unsigned>(m_nBits & ((static_cast<std::uint64_t>(1) << nBits) - 1));
+        }
+
+        void Drop(unsigned nBits)
+        {
+            m_nBits >>= nBits;
+            m_nCount -= nBits;
+        }
+
+        unsigned Get(unsigned nBits)
+        {
+            unsigned nValue = Peek(nBits);
+            Drop(nBits);
+            return nValue;
+        }
+
+        // moves to the next byte boundary and hands buffered bytes back to the input
+        void AlignToByte()
+        {
+            Drop(m_nCount & 7);
+            std::size_t nBuffered = m_nCount / 8;
+            nBuffered = (nBuffered > m_nPadding) ? nBuffered - m_nPadding : 0;
+            m_pCur -= nBuffered;
+            m_nBits = 0;
+            m_nCount = 0;
+            m_nPadding = 0;
+        }
+
+        // only valid right after AlignToByte
+        const unsigned char* Position() const { return m_pCur; }
+        void Skip(std::size_t nBytes) { m_pCur += nBytes; }
+        std::size_t Available() const { return static_cast<std::size_t>(m_pEnd - m_pCur); }
+
+        bool Overrun() const
+        {
+            return m_nPadding * 8 > m_nCount;
+        }
+
+    private:
+        const unsigned char* m_pCur;
+        const unsigned char* m_pEnd;
+        std::uint64_t m_nBits;
+        unsigned m_nCount;
+        std::size_t m_nPadding;
+
+        void Refill()
+        {
+            while (m_nCount <= 56)
+            {
+                std::uint64_t nByte = 0;
+                if (m_pCur < m_pEnd)
+                {
+                    nByte = *m_pCur++;
+                }
+                else
+                {
+                    ++m_nPadding;
+                }
+                m_nBits |= nByte << m_nCount;
+                m_nCount += 8;
+            }
+        }
+    };
+
+
+    // canonical Huffman code decoded with a single lookup table
+    class cHuffman
+    {
+    public:
+        bool Build(const unsigned char* pLengths, unsigned nSymbols)
+        {
+            unsigned aCount[16] = {0};
+            m_nMaxBits = 0;
+            for (unsigned i=0; i<nSymbols; ++i)
+            {
+                ++aCount[pLengths[i]];
+                m_nMaxBits = (pLengths[i] > m_nMaxBits) ? pLengths[i] : m_nMaxBits;
+            }
+            aCount[0] = 0;
+
+            // over subscribed codes are invalid, incomplete ones are allowed
+            int nLeft = 1;
+            for (unsigned nLength=1; nLength<16; ++nLength)
+            {
+                nLeft = nLeft * 2 - static_cast<int>(aCount[nLength]);
+                if (nLeft < 0)
+                {
+                    return false;
+                }
+            }
+
+            unsigned aNextCode[16] = {0};
+            for (unsigned nLength=1; nLength<16; ++nLength)
+            {
+                aNextCode[nLength] = (aNextCode[nLength-1] + aCount[nLength-1]) << 1;
+            }
+
+            m_vecTable.assign(static_cast<std::size_t>(1) << m_nMaxBits, 0);
+            for (unsigned nSymbol=0; nSymbol<nSymbols; ++nSymbol)
+            {
+                unsigned nLength = pLengths[nSymbol];
+                if (nLength == 0)
+                {
+                    continue;
+                }
+
+                unsigned nCode = aNextCode[nLength]++;
+                unsigned nReversed = 0;
+                for (unsigned i=0; i<nLength; ++i)
+                {
+                    nReversed = (nReversed << 1) | ((nCode >> i) & 1);
+                }
+
+                for (std::size_t nEntry=nReversed; nEntry<m_vecTable.size(); nEntry += (static_cast<std::size_t>(1) << nLength))
+                {
+                    m_vecTable[nEntry] = static_cast<std::uint16_t>((nSymbol << 4) | nLength);
+                }
+            }
+            return true;
+        }
+
+        // returns the symbol or -1 for a code that is not part of the table
+        int Decode(cBitReader& oBits) const
+        {
+            unsigned nEntry = m_vecTable[oBits.Peek(m_nMaxBits)];
+            unsigned nLength = nEntry & 15;
+            if (nLength == 0)
+            {
+                return -1;
+            }
+            oBits.Drop(nLength);
+            return static_cast<int>(nEntry >> 4);
+        }
+
+    private:
+        unsigned m_nMaxBits;
+        std::vector<std::uint16_t> m_vecTable;
+    };
+
+
+    class cInflater
+    {
+    public:
+        typedef std::function<void(const unsigned char*, std::size_t)> tSink;
+
+        cInflater(std::size_t nChunkSize, tSink oSink) :
+            m_vecWindow(nWindowSize + nChunkSize),
+            m_nPos(0),
+            m_nFlushed(0),
+            m_oSink(oSink)
+        {
+        }
+
+        // inflates one deflate stream, returns the position behind it
+        cGzipReader::eError Inflate(cBitReader& oBits)
+        {
+            bool bFinal = false;
+            while (!bFinal)
+            {
+                bFinal = oBits.Get(1) != 0;
+                unsigned nType = oBits.Get(2);
+
+                cGzipReader::eError eError = cGzipReader::GZ_DATA;
+                if (nType == 0)
+                {
+                    eError = InflateStored(oBits);
+                }
+                else if (nType == 1)
+                {
+                    BuildFixedCodes();
+                    eError = InflateCodes(oBits, m_oFixedLiterals, m_oFixedDistances);
+                }
+                else if (nType == 2)
+                {
+                    eError = InflateDynamic(oBits);
+                }
+
+                if (eError != cGzipReader::GZ_OK)
+                {
+                    return eError;
+                }
+                if (oBits.Overrun())
+                {
+                    return cGzipReader::GZ_TRUNCATED;
+                }
+            }
+
+            oBits.AlignToByte();
+            return cGzipReader::GZ_OK;
+        }
+
+        // hands out everything that has not been flushed yet
+        void Finish()
+        {
+            Flush(false);
+        }
+
+    private:
+        std::vector<unsigned char> m_vecWindow;
+        std::size_t m_nPos;
+        std::size_t m_nFlushed;
+        tSink m_oSink;
+
+        cHuffman m_oFixedLiterals;
+        cHuffman m_oFixedDistances;
+        bool m_bFixedBuilt = false;
+
+        cHuffman m_oLiterals;
+        cHuffman m_oDistances;
+
+        void Flush(bool bKeepWindow)
+        {
+            if (m_nPos > m_nFlushed)
+            {
+                m_oSink(&m_vecWindow[m_nFlushed], m_nPos - m_nFlushed);
+            }
+            m_nFlushed = m_nPos;
+
+            // back references reach at most 32 KiB back, keep that much
+            if (bKeepWindow && m_nPos > nWindowSize)
+            {
+                memmove(&m_vecWindow[0], &m_vecWindow[m_nPos - nWindowSize], nWindowSize);
+                m_nPos = nWindowSize;
+                m_nFlushed = nWindowSize;
+            }
+        }
+
+        void Reserve(std::size_t nBytes)
+        {
+            if (m_nPos + nBytes > m_vecWindow.size())
+            {
+                Flush(true);
+            }
+        }
+
+        void BuildFixedCodes()
+        {
+            if (m_bFixedBuilt)
+            {
+                return;
+            }
+
+            unsigned char aLengths[288];
+            memset(aLengths, 8, 144);
+            memset(aLengths + 144, 9, 112);
+            memset(aLengths + 256, 7, 24);
+            memset(aLengths + 280, 8, 8);
+            m_oFixedLiterals.Build(aLengths, 288);
+
+            memset(aLengths, 5, 30);
+            m_oFixedDistances.Build(aLengths, 30);
+            m_bFixedBuilt = true;
+        }
+
+        cGzipReader::eError InflateStored(cBitReader& oBits)
+        {
+            oBits.AlignToByte();
+            if (oBits.Available() < 4)
+            {
+                return cGzipReader::GZ_TRUNCATED;
+            }
+
+            const unsigned char* pHeader = oBits.Position();
+            unsigned nLength = pHeader[0] | (pHeader[1] << 8);
+            unsigned nComplement = pHeader[2] | (pHeader[3] << 8);
+            oBits.Skip(4);
+
+            if ((nLength ^ 0xffffu) != nComplement)
+            {
+                return cGzipReader::GZ_DATA;
+            }
+            if (oBits.Available() < nLength)
+            {
+                return cGzipReader::GZ_TRUNCATED;
+            }
+
+            const unsigned char* pData = oBits.Position();
+            std::size_t nLeft = nLength;
+            while (nLeft > 0)
+            {
+                Reserve(1);
+                std::size_t nCopy = m_vecWindow.size() - m_nPos;
+                nCopy = (nCopy < nLeft) ? nCopy : nLeft;
+                memcpy(&m_vecWindow[m_nPos], pData, nCopy);
+                m_nPos += nCopy;
+                pData += nCopy;
+                nLeft -= nCopy;
+            }
+            oBits.Skip(nLength);
+            return cGzipReader::GZ_OK;
+        }
+
+        cGzipReader::eError InflateDynamic(cBitReader& oBits)
+        {
+            unsigned nLiterals = oBits.Get(5) + 257;
+            unsigned nDistances = oBits.Get(5) + 1;
+            unsigned nCodeLengths = oBits.Get(4) + 4;
+            if (nLiterals > 286 || nDistances > 30)
+            {
+                return cGzipReader::GZ_DATA;
+            }
+
+            unsigned char aLengths[286 + 30];
+            memset(aLengths, 0, 19);
+            for (unsigned i=0; i<nCodeLengths; ++i)
+            {
+                aLengths[aCodeLengthOrder[i]] = static_cast<unsigned char>(oBits.Get(3));
+            }
+
+            cHuffman oCodeLengths;
+            if (!oCodeLengths.Build(aLengths, 19))
+            {
+                return cGzipReader::GZ_DATA;
+            }
+
+            unsigned nIndex = 0;
+            while (nIndex < nLiterals + nDistances)
+            {
+                int nSymbol = oCodeLengths.Decode(oBits);
+                if (nSymbol < 0)
+                {
+                    return cGzipReader::GZ_DATA;
+                }
+
+                if (nSymbol < 16)
+                {
+                    aLengths[nIndex++] = static_cast<unsigned char>(nSymbol);
+                    continue;
+                }
+
+                unsigned char nRepeated = 0;
+                unsigned nRepeat = 0;
+                if (nSymbol == 16)
+                {
+                    if (nIndex == 0)
+                    {
+                        return cGzipReader::GZ_DATA;
+                    }
+                    nRepeated = aLengths[nIndex - 1];
+                    nRepeat = 3 + oBits.Get(2);
+                }
+                else if (nSymbol == 17)
+                {
+                    nRepeat = 3 + oBits.Get(3);
+                }
+                else
+                {
+                    nRepeat = 11 + oBits.Get(7);
+                }
+
+                if (nIndex + nRepeat > nLiterals + nDistances)
+                {
+                    return cGzipReader::GZ_DATA;
+                }
+                while (nRepeat--)
+                {
+                    aLengths[nIndex++] = nRepeated;
+                }
+            }
+
+            // the end of block code has to be there
+            if (aLengths[256] == 0)
+            {
+                return cGzipReader::GZ_DATA;
+            }
+
+            if (!m_oLiterals.Build(aLengths, nLiterals)
+                || !m_oDistances.Build(aLengths + nLiterals, nDistances))
+            {
+                return cGzipReader::GZ_DATA;
+            }
+
+            return InflateCodes(oBits, m_oLiterals, m_oDistances);
+        }
+
+        cGzipReader::eError InflateCodes(cBitReader& oBits, const cHuffman& oLiterals, const cHuffman& oDistances)
+        {
+            for (;;)
+            {
+                int nSymbol = oLiterals.Decode(oBits);
+                if (nSymbol < 0)
+                {
+                    return cGzipReader::GZ_DATA;
+                }
+
+                if (nSymbol < 256)
+                {
+                    Reserve(1);
+                    m_vecWindow[m_nPos++] = static_cast<unsigned char>(nSymbol);
+                    continue;
+                }
+
+                if (nSymbol == 256)
+                {
+                    return cGzipReader::GZ_OK;
+                }
+
+                nSymbol -= 257;
+                if (nSymbol >= 29)
+                {
+                    return cGzipReader::GZ_DATA;
+                }
+                unsigned nLength = aLengthBase[nSymbol] + oBits.Get(aLengthExtra[nSymbol]);
+
+                int nDistanceSymbol = oDistances.Decode(oBits);
+                if (nDistanceSymbol < 0 || nDistanceSymbol >= 30)
+                {
+                    return cGzipReader::GZ_DATA;
+                }
+                std::size_t nDistance = aDistanceBase[nDistanceSymbol] + oBits.Get(aDistanceExtra[nDistanceSymbol]);
+
+                Reserve(nLength);
+                if (nDistance > m_nPos)
+                {
+                    return cGzipReader::GZ_DATA;
+                }
+
+                // source and target may overlap, copy byte by byte
+                unsigned char* pTarget = &m_vecWindow[m_nPos];
+                const unsigned char* pSource = pTarget - nDistance;
+                for (unsigned i=0; i<nLength; ++i)
+                {
+                    pTarget[i] = pSource[i];
+                }
+                m_nPos += nLength;
+
+                if (oBits.Overrun())
+                {
+                    return cGzipReader::GZ_TRUNCATED;
+                }
+            }
+        }
+    };
+
+
+    // skips a gzip member header, returns false if it is not valid
+    bool SkipGzipHeader(cBitReader& oBits)
+    {
+        oBits.AlignToByte();
+        if (oBits.Available() < 10)
+        {
+            return false;
+        }
+
+        const unsigned char* pHeader = oBits.Position();
+        if (pHeader[0] != 0x1f || pHeader[1] != 0x8b || pHeader[2] != 8)
+        {
+            return false;
+        }
+
+        unsigned char nFlags = pHeader[3];
+        oBits.Skip(10);
+
+        // FEXTRA
+        if (nFlags & 4)
+        {
+            if (oBits.Available() < 2)
+            {
+                return false;
+            }
+            std::size_t nExtra = oBits.Position()[0] | (oBits.Position()[1] << 8);
+            oBits.Skip(2);
+            if (oBits.Available() < nExtra)
+            {
+                return false;
+            }
+            oBits.Skip(nExtra);
+        }
+
+        // FNAME, FCOMMENT: zero terminated strings
+        for (unsigned char nFlag : {static_cast<unsigned char>(8), static_cast<unsigned char>(16)})
+        {
+            if (nFlags & nFlag)
+            {
+                const void* pZero = memchr(oBits.Position(), 0, oBits.Available());
+                if (!pZero)
+                {
+                    return false;
+                }
+                oBits.Skip(static_cast<const unsigned char*>(pZero) - oBits.Position() + 1);
+            }
+        }
+
+        // FHCRC
+        if (nFlags & 2)
+        {
+            if (oBits.Available() < 2)
+            {
+                return false;
+            }
+            oBits.Skip(2);
+        }
+        return true;
+    }
+
+
+    std::uint32_t ReadLE32(const unsigned char* p)
+    {
+        return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8)
+             | (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+    }
+
+
+    std::uint32_t ReadBE32(const unsigned char* p)
+    {
+        return (static_cast<std::uint32_t>(p[0]) << 24) | (static_cast<std::uint32_t>(p[1]) << 16)
+             | (static_cast<std::uint32_t>(p[2]) << 8) | static_cast<std::uint32_t>(p[3]);
+    }
+
+
+    // bounded queue of decompressed chunks between the inflate and the parse stage
+    class cChunkQueue
+    {
+    public:
+        cChunkQueue(std::size_t nDepth) : m_nDepth(nDepth), m_bDone(false), m_bCancelled(false) { }
+
+        bool Push(std::vector<char>& vecChunk)
+        {
+            std::unique_lock<std::mutex> oLock(m_oMutex);
+            m_oNotFull.wait(oLock, [this] { return m_oChunks.size() < m_nDepth || m_bCancelled; });
+            if (m_bCancelled)
+            {
+                return false;
+            }
+            m_oChunks.push_back(std::vector<char>());
+            m_oChunks.back().swap(vecChunk);
+            m_oNotEmpty.notify_one();
+            return true;
+        }
+
+        bool Pop(std::vector<char>& vecChunk)
+        {
+            std::unique_lock<std::mutex> oLock(m_oMutex);
+            m_oNotEmpty.wait(oLock, [this] { return !m_oChunks.empty() || m_bDone; });
+            if (m_oChunks.empty())
+            {
+                return false;
+            }
+            vecChunk.swap(m_oChunks.front());
+            m_oChunks.pop_front();
+            m_oNotFull.notify_one();
+            return true;
+        }
+
+        void Done()
+        {
+            std::lock_guard<std::mutex> oLock(m_oMutex);
+            m_bDone = true;
+            m_oNotEmpty.notify_all();
+        }
+
+        void Cancel()
+        {
+            std::lock_guard<std::mutex> oLock(m_oMutex);
+            m_bCancelled = true;
+            m_oNotFull.notify_all();
+        }
+
+    private:
+        std::size_t m_nDepth;
+        bool m_bDone;
+        bool m_bCancelled;
+        std::deque<std::vector<char>> m_oChunks;
+        std::mutex m_oMutex;
+        std::condition_variable m_oNotFull;
+        std::condition_variable m_oNotEmpty;
+    };
+
+
+    struct sCancelled {};
+
+
+    cGzipReader::eError InflateFile(const cMappedFile& oFile, std::size_t nChunkSize, cChunkQueue& oQueue)
+    {
+        const unsigned char* pBegin = reinterpret_cast<const unsigned char*>(oFile.Begin());
+        const unsigned char* pEnd = reinterpret_cast<const unsigned char*>(oFile.End());
+        cBitReader oBits(pBegin, pEnd);
+
+        cCRC32 oCRC;
+        cAdler32 oAdler;
+        std::uint64_t nMemberSize = 0;
+        std::vector<char> vecChunk;
+
+        bool bGzip = (oFile.Size() >= 2 && pBegin[0] == 0x1f && pBegin[1] == 0x8b);
+        cInflater oInflater(nChunkSize, [&](const unsigned char* pData, std::size_t nSize)
+        {
+            if (bGzip)
+            {
+                oCRC.Update(pData, nSize);
+            }
+            else
+            {
+                oAdler.Update(pData, nSize);
+            }
+            nMemberSize += nSize;
+
+            vecChunk.assign(reinterpret_cast<const char*>(pData), reinterpret_cast<const char*>(pData) + nSize);
+            if (!oQueue.Push(vecChunk))
+            {
+                throw sCancelled();
+            }
+        });
+
+        if (!bGzip)
+        {
+            // zlib: CMF, FLG without preset dictionary, deflate, big endian adler32
+            if (oFile.Size() < 6 || (pBegin[0] & 15) != 8 || ((pBegin[0] << 8) | pBegin[1]) % 31 != 0
+                || (pBegin[1] & 32))
+            {
+                return cGzipReader::GZ_HEADER;
+            }
+            oBits.Get(16);
+
+            cGzipReader::eError eError = oInflater.Inflate(oBits);
+            if (eError != cGzipReader::GZ_OK)
+            {
+                return eError;
+            }
+            oInflater.Finish();
+
+            if (oBits.Available() < 4)
+            {
+                return cGzipReader::GZ_TRUNCATED;
+            }
+            return (ReadBE32(oBits.Position()) == oAdler.Value()) ? cGzipReader::GZ_OK
+                                                                   : cGzipReader::GZ_CHECKSUM;
+        }
+
+        // gzip files may consist of several members that are simply concatenated
+        while (oBits.Available() > 0)
+        {
+            if (!SkipGzipHeader(oBits))
+            {
+                return cGzipReader::GZ_HEADER;
+            }
+
+            oCRC = cCRC32();
+            nMemberSize = 0;
+
+            cGzipReader::eError eError = oInflater.Inflate(oBits);
+            if (eError != cGzipReader::GZ_OK)
+            {
+                return eError;
+            }
+            oInflater.Finish();
+
+            if (oBits.Available() < 8)
+            {
+                return cGzipReader::GZ_TRUNCATED;
+            }
+            if (ReadLE32(oBits.Position()) != oCRC.Value()
+                || ReadLE32(oBits.Position() + 4) != static_cast<std::uint32_t>(nMemberSize))
+            {
+                return cGzipReader::GZ_CHECKSUM;
+            }
+            oBits.Skip(8);
+        }
+
+        return cGzipReader::GZ_OK;
+    }
+}
+
+
+cGzipReader::cGzipReader(std::size_t nChunkSize, std::size_t nQueueDepth) :
+    // a chunk has to hold at least one match of 258 bytes
+    m_nChunkSize(nChunkSize < 4096 ? 4096 : nChunkSize),
+    m_nQueueDepth(nQueueDepth ? nQueueDepth : 1)
+{
+}
+
+
+bool cGzipReader::IsCompressed(const std::string& sFilename)
+{
+    return EndsWith(sFilename, ".gz") || EndsWith(sFilename, ".zz");
+}
+
+
+const char* cGzipReader::ErrorText(eError eCode)
+{
+    switch (eCode)
+    {
+    case GZ_OK:        return "no error";
+    case GZ_OPEN:      return "file can not be opened";
+    case GZ_HEADER:    return "no valid gzip or zlib header";
+    case GZ_DATA:      return "invalid deflate data";
+    case GZ_TRUNCATED: return "compressed data ends unexpectedly";
+    case GZ_CHECKSUM:  return "checksum of decompressed data does not match";
+    }
+    return "unknown error";
+}
+
+
+cGzipReader::eError cGzipReader::Read(const std::string& sFilename, tChunkHandler oHandler)
+{
+    cMappedFile oFile;
+    if (!oFile.Open(sFilename))
+    {
+        return GZ_OPEN;
+    }
+
+    cChunkQueue oQueue(m_nQueueDepth);
+    eError eResult = GZ_OK;
+    // anything else thrown while inflating (out of memory) goes to the caller
+    std::exception_ptr pInflateError;
+
+    // stage 1: inflate on a worker thread
+    std::thread oInflateThread([&]
+    {
+        try
+        {
+            eResult = InflateFile(oFile, m_nChunkSize, oQueue);
+        }
+        catch (const sCancelled&)
+        {
+        }
+        catch (...)
+        {
+            pInflateError = std::current_exception();
+        }
+        oQueue.Done();
+    });
+
+    // stage 2: hand the chunks to the caller while the next ones are inflated
+    std::vector<char> vecChunk;
+    try
+    {
+        while (oQueue.Pop(vecChunk))
+        {
+            oHandler(vecChunk.data(), vecChunk.data() + vecChunk.size());
+        }
+    }
+    catch (...)
+    {
+        oQueue.Cancel();
+        oInflateThread.join();
+        throw;
+    }
+
+    oInflateThread.join();
+    if (pInflateError)
+    {
+        std::rethrow_exception(pInflateError);
+    }
+    return eResult;
+}
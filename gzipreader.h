@@ -0,0 +1,43 @@
+#ifndef CGZIPREADER_H
+#define CGZIPREADER_H
+
+#include <string>
+#include <functional>
+#include <cstddef>
+
+
+/* Streaming decompression of gzip (RFC 1952, also multi member files) and
+ * zlib (RFC 1950) files. The compressed file is memory mapped and inflated
+ * on a worker thread; the decompressed data is handed to the caller's
+ * handler in order and in chunks of about nChunkSize bytes, while the worker
+ * already inflates the next ones. At most nQueueDepth chunks are buffered,
+ * so memory use does not depend on the size of the file. */
+class cGzipReader
+{
+public:
+  typedef std::function<void(const char* pBegin, const char* pEnd)> tChunkHandler;
+
+  enum eError
+  {
+    GZ_OK = 0,
+    GZ_OPEN,
+    GZ_HEADER,
+    GZ_DATA,
+    GZ_TRUNCATED,
+    GZ_CHECKSUM
+  };
+
+  cGzipReader(std::size_t nChunkSize = 1 << 20, std::size_t nQueueDepth = 4);
+
+  // calls oHandler on the calling thread for every chunk, returns GZ_OK or the first error
+  eError Read(const std::string& sFilename, tChunkHandler oHandler);
+
+  static const char* ErrorText(eError eCode);
+  static bool IsCompressed(const std::string& sFilename);
+
+private:
+  std::size_t m_nChunkSize;
+  std::size_t m_nQueueDepth;
+};
+
+#endif // CGZIPREADER_H
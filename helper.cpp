@@ -1,20 +1,31 @@
 #include "helper.h"
+#include "fielddecoder.h"
 
 
 std::int64_t SToLL(const std::string& sStrIn)
+{
+    return SToLL(sStrIn.data(), sStrIn.data() + sStrIn.size());
+}
+
+
+float SToF(const std::string& sStrIn)
+{
+    return SToF(sStrIn.data(), sStrIn.data() + sStrIn.size());
+}
+
+
+std::int64_t SToLL(const char* pBegin, const char* pEnd)
 {
     std::int64_t nLL;
-    std::stringstream sStrOut(sStrIn);
-    sStrOut >> nLL;
+    ParseInt64(pBegin, pEnd, nLL);
     return nLL;
 }
 
 
-float SToF(const std::string& sStrIn)
+float SToF(const char* pBegin, const char* pEnd)
 {
     float fF;
-    std::stringstream sStrOut(sStrIn);
-    sStrOut >> fF;
+    ParseFloat(pBegin, pEnd, fF);
     return fF;
 }
 
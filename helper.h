@@ -3,14 +3,21 @@
 
 #include <string>
 #include <sstream>
+#include <cstdint>
 #define _USE_MATH_DEFINES
 #include <math.h>
 
 class fileNotFound {};
+class corruptFile {};
 
 std::int64_t SToLL(const std::string& sStrIn);
 float SToF(const std::string& sStrIn);
 
+// same for a character range that is not null terminated, without allocating;
+// for whole rows see DecodeFloats in fielddecoder.h
+std::int64_t SToLL(const char* pBegin, const char* pEnd);
+float SToF(const char* pBegin, const char* pEnd);
+
 bool EndsWith(std::string const &oString,
               std::string const &oEnding);
 
@@ -1,167 +1,131 @@
 #include "hierarchicmotion.h"
 
+#include <algorithm>
+
 
 cHierarchicMotion::cHierarchicMotion() :
     m_bInit{false},
-    m_nInitCallCounter{0}
+    m_nCalibrationFrames{50},
+    m_nInitCallCounter{0},
+    m_aLimbLengths{},
+    m_nMaxGapFrames{0},
+    m_fFrameRate{30.0f},
+    m_nLastTimestamp{0}
 {
-    for (int i=0; i<JT_Count; ++i)
+}
+
+
+void cHierarchicMotion::SetFilter(std::shared_ptr<cFrameFilter> pFilter, unsigned nMaxGapFrames, float fFrameRate)
+{
+    m_pFilter = pFilter;
+    if (m_pFilter)
     {
-        auto eType = static_cast<eJointType>(i);
-        m_mapJointStreams[eType] = std::shared_ptr<cJointStream>(new cJointStream{eType});
+        m_pFilter->Reset();
     }
+    m_nMaxGapFrames = nMaxGapFrames;
+    m_fFrameRate = (fFrameRate > 0.0f) ? fFrameRate : 30.0f;
+}
 
-    m_vecTimeStream = std::make_shared<std::vector<std::int64_t>>();
 
-    BuildHierarchy();
+std::string cHierarchicMotion::FilterDescription() const
+{
+    std::string sDescription = m_pFilter ? m_pFilter->Describe() : std::string();
+    if (m_nMaxGapFrames > 0)
+    {
+        sDescription += (sDescription.empty() ? "" : ", ") + std::string("gaps ") + std::to_string(m_nMaxGapFrames)
+                      + " at " + std::to_string(m_fFrameRate) + " fps";
+    }
+    return sDescription;
+}
+
+
+void cHierarchicMotion::SetCalibrationFrames(unsigned nFrames)
+{
+    m_nCalibrationFrames = (nFrames > 0) ? nFrames : 1;
 }
 
 
-void cHierarchicMotion::BuildHierarchy()
+unsigned cHierarchicMotion::CalibrationFrames() const
 {
-// use spine_mid as root
-
-// lower body
-m_mapJointStreams[JT_SpineBase]->AddSubJointStream(m_mapJointStreams[JT_SpineMid]);
-// left hip
-m_mapJointStreams[JT_SpineBase]->AddSubJointStream(m_mapJointStreams[JT_HipLeft]);
-// left leg
-m_mapJointStreams[JT_HipLeft]->AddSubJointStream(m_mapJointStreams[JT_KneeLeft]);
-m_mapJointStreams[JT_KneeLeft]->AddSubJointStream(m_mapJointStreams[JT_AnkleLeft]);
-
-// left food
-m_mapJointStreams[JT_AnkleLeft]->AddSubJointStream(m_mapJointStreams[JT_FootLeft]);
-// right hip
-m_mapJointStreams[JT_SpineBase]->AddSubJointStream(m_mapJointStreams[JT_HipRight]);
-// left leg
-m_mapJointStreams[JT_HipRight]->AddSubJointStream(m_mapJointStreams[JT_KneeRight]);
-m_mapJointStreams[JT_KneeRight]->AddSubJointStream(m_mapJointStreams[JT_AnkleRight]);
-// left food
-m_mapJointStreams[JT_AnkleRight]->AddSubJointStream(m_mapJointStreams[JT_FootRight]);
-// upper body
-m_mapJointStreams[JT_SpineMid]->AddSubJointStream(m_mapJointStreams[JT_SpineShoulder]);
-m_mapJointStreams[JT_SpineShoulder]->AddSubJointStream(m_mapJointStreams[JT_Neck]);
-m_mapJointStreams[JT_Neck]->AddSubJointStream(m_mapJointStreams[JT_Head]);
-// left shoulder
-m_mapJointStreams[JT_SpineShoulder]->AddSubJointStream(m_mapJointStreams[JT_ShoulderLeft]);
-// left arm
-m_mapJointStreams[JT_ShoulderLeft]->AddSubJointStream(m_mapJointStreams[JT_ElbowLeft]);
-m_mapJointStreams[JT_ElbowLeft]->AddSubJointStream(m_mapJointStreams[JT_WristLeft]);
-m_mapJointStreams[JT_WristLeft]->AddSubJointStream(m_mapJointStreams[JT_HandLeft]);
-// left hand
-m_mapJointStreams[JT_HandLeft]->AddSubJointStream(m_mapJointStreams[JT_ThumbLeft]);
-m_mapJointStreams[JT_HandLeft]->AddSubJointStream(m_mapJointStreams[JT_HandTipLeft]);
-
-// right shoulder
-m_mapJointStreams[JT_SpineShoulder]->AddSubJointStream(m_mapJointStreams[JT_ShoulderRight]);
-// right arm
-m_mapJointStreams[JT_ShoulderRight]->AddSubJointStream(m_mapJointStreams[JT_ElbowRight]);
-m_mapJointStreams[JT_ElbowRight]->AddSubJointStream(m_mapJointStreams[JT_WristRight]);
-m_mapJointStreams[JT_WristRight]->AddSubJointStream(m_mapJointStreams[JT_HandRight]);
-
-// right hand
-m_mapJointStreams[JT_HandRight]->AddSubJointStream(m_mapJointStreams[JT_ThumbRight]);
-m_mapJointStreams[JT_HandRight]->AddSubJointStream(m_mapJointStreams[JT_HandTipRight]);
+    return m_nCalibrationFrames;
 }
 
 
-bool CompareOffsets(std::shared_ptr<cJoint> oA, std::shared_ptr<cJoint> oB)
+namespace
 {
-    return (oA->GetOffset().Magnitude() < oB->GetOffset().Magnitude());
+    cVector3<float> GetPosition(const float* pPositions, int nJoint)
+    {
+        return cVector3<float>(pPositions[nJoint * 3], pPositions[nJoint * 3 + 1], pPositions[nJoint * 3 + 2]);
+    }
 }
 
 
-void cHierarchicMotion::Init(std::vector<std::shared_ptr<cJoint>> oJoints)
+void cHierarchicMotion::Init(std::int64_t nTime, const float* pPositions)
 {
     // validity check
-    if (Zero(oJoints))
+    if (nTime == 0)
     {
+        m_oStats.AddWithoutTime();
         return;
     }
+    AddTimestamp(nTime);
+    if (Zero(pPositions))
+    {
+        m_oStats.AddCollapsed();
+        return;
+    }
+    m_oStats.AddCalibration();
 
-    AddJointSet(oJoints);
-
-    // save offset for last elements in stream at
     for (int i=0; i<JT_Count; ++i)
     {
         auto eType = static_cast<eJointType>(i);
-        auto oPosition = m_mapJointStreams[eType]->GetLastJoint()->GetPosition();
-
-        for (auto pSubJointStream : m_mapJointStreams[eType]->m_oSubJointStream)
+        if (!IsRoot(eType))
         {
-            auto oSubPosition = pSubJointStream->GetLastJoint()->GetPosition();
-            auto oOffset = oSubPosition - oPosition;
-
-            pSubJointStream->GetLastJoint()->SetOffset(oOffset);
+            auto oOffset = GetPosition(pPositions, eType) - GetPosition(pPositions, aJointParents[eType]);
+            m_aLimbEstimators[i].Add(oOffset.Magnitude());
         }
     }
-
-    // and create median of sizes of the individual limbs
-    if (++m_nInitCallCounter <= nNumberOfInitSets)
+    for (std::size_t nColumn=0; nColumn<cFrameArena::nColumns; ++nColumn)
     {
-        return;
+        m_aPoseEstimators[nColumn].Add(pPositions[nColumn]);
     }
 
-
-    // sort joints of different streams
-    for (auto oMapElements : m_mapJointStreams)
+    // and create median of sizes of the individual limbs
+    if (++m_nInitCallCounter < m_nCalibrationFrames)
     {
-        auto pJointStream = oMapElements.second;
-        std::sort(pJointStream->begin(), pJointStream->end(), CompareOffsets);
-
-        // create median for offset
-        std::shared_ptr<cJoint> pExampleJoint = pJointStream->at(pJointStream->size() / 2);
-        pJointStream->SetOffset(pExampleJoint->GetOffset());
-        // clear jointstream and make sure there is one joint in the stream
-        pJointStream->clear();
-        pJointStream->push_back(pExampleJoint);
+        return;
     }
 
-    // Print result of init to screen
-    std::cout << "------------- INIT --------------" << std::endl;
-    for (auto oMapElements : m_mapJointStreams)
+    float aPose[cFrameArena::nColumns];
+    for (std::size_t nColumn=0; nColumn<cFrameArena::nColumns; ++nColumn)
     {
-        auto pStream = oMapElements.second;
-        std::cout << pStream->GetName() << " = " << pStream->GetOffset().Magnitude() << std::endl;
+        aPose[nColumn] = static_cast<float>(m_aPoseEstimators[nColumn].Value());
     }
-    std::cout << "------------- DONE --------------" << std::endl;
-
-    m_bInit = true;
-}
-
-
-
-
-void cHierarchicMotion::AddJointSet(std::vector<std::shared_ptr<cJoint>> oJoints)
-{
-    for (auto pJoint : oJoints)
+    for (int i=0; i<JT_Count; ++i)
     {
-        m_mapJointStreams[pJoint->GetType()]->push_back(pJoint);
+        m_aLimbLengths[i] = static_cast<float>(m_aLimbEstimators[i].Value());
     }
-}
+    m_oValidator.SetLimbLengths(m_aLimbLengths);
 
+    // make sure there is one frame, the calibrated pose
+    m_oFrames.Clear();
+    m_oFrames.PushBack(0, aPose);
 
-void cHierarchicMotion::RemoveLastJointSet()
-{
-    for (int i=0; i<JT_Count; ++i)
-    {
-        auto eType = static_cast<eJointType>(i);
-        m_mapJointStreams[eType]->pop_back();
-    }
+    m_bInit = true;
 }
 
 
-bool cHierarchicMotion::Zero(std::vector<std::shared_ptr<cJoint>>& oJoints)
+bool cHierarchicMotion::Zero(const float* pPositions)
 {
     float fMaxX = -100, fMinX = 100, fMaxY = -100, fMinY = 100, fMaxZ = -100, fMinZ = 100;
 
     float fCurX, fCurY, fCurZ;
 
-    for (auto pJoint : oJoints)
+    for (int i=0; i<JT_Count; ++i)
     {
-        fCurX = static_cast<float>(pJoint->GetPosition()[0]);
-        fCurY = static_cast<float>(pJoint->GetPosition()[1]);
-        fCurZ = static_cast<float>(pJoint->GetPosition()[2]);
+        fCurX = pPositions[i * 3];
+        fCurY = pPositions[i * 3 + 1];
+        fCurZ = pPositions[i * 3 + 2];
 
         fMinX = (fCurX < fMinX) ? fCurX : fMinX;
         fMinY = (fCurY < fMinY) ? fCurY : fMinY;
@@ -180,62 +144,173 @@ bool cHierarchicMotion::Zero(std::vector<std::shared_ptr<cJoint>>& oJoints)
 }
 
 
-void cHierarchicMotion::ExtendMotion(std::int64_t nTime, std::vector<std::shared_ptr<cJoint>> oJoints)
+bool cHierarchicMotion::LimbsFit(const float* pPositions, eJointType& eBone, double& fDeviation)
 {
-    // validity check
-    if (Zero(oJoints))
+    // Check currently meassured limbs have right length
+    for (const sBone& oBone : aBones)
     {
+        auto oOffset = GetPosition(pPositions, oBone.eParent) - GetPosition(pPositions, oBone.eChild);
+        auto fCurLimbLength = oOffset.Magnitude();
+        auto fLimbLength = m_aLimbLengths[oBone.eChild];
+
+        if (aLimbChecked[oBone.eChild]
+            && !EQPercentageDiff(static_cast<double>(fLimbLength),
+                                 static_cast<double>(fCurLimbLength), 0.3f))
+        {
+            eBone = oBone.eChild;
+            fDeviation = cFrameValidator::Deviation(fLimbLength, fCurLimbLength);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+void cHierarchicMotion::ExtendMotion(std::int64_t nTime, const float* pPositions)
+{
+    // validity check, nothing is stored before the frame passed
+    eJointType eBone;
+    double fDeviation;
+    if (nTime == 0)
+    {
+        m_oStats.AddWithoutTime();
         return;
     }
+    AddTimestamp(nTime);
+    if (Zero(pPositions))
+    {
+        m_oStats.AddCollapsed();
+    }
+    else if (!LimbsFit(pPositions, eBone, fDeviation))
+    {
+        m_oStats.AddLimbMismatch(eBone, fDeviation);
+    }
+    else if (!m_oFrames.Empty() && nTime < m_oFrames.Time(m_oFrames.Size() - 1))
+    {
+        m_oStats.AddOutOfOrder();
+    }
+    else
+    {
+        Append(nTime, pPositions);
+        m_oStats.AddAccepted();
+    }
+}
 
-    // add joints to data structure, this is necessary for a validity check
-    AddJointSet(oJoints);
 
-    // Check currently meassured limbs have right length
-    for (int i=0; i<JT_Count; ++i)
+void cHierarchicMotion::AddTimestamp(std::int64_t nTime)
+{
+    // a row older than the newest one is not a step of the sensor clock
+    if (m_nLastTimestamp != 0 && nTime > m_nLastTimestamp)
     {
-        auto eType = static_cast<eJointType>(i);
-        auto pCurrentJointStream = m_mapJointStreams[eType];
+        m_oFrameInterval.Add(static_cast<double>(nTime - m_nLastTimestamp));
+    }
+    m_nLastTimestamp = std::max(m_nLastTimestamp, nTime);
+}
+
+
+double cHierarchicMotion::FrameStep() const
+{
+    return (m_oFrameInterval.Count() > 0) ? m_oFrameInterval.Value() : 0.0;
+}
 
-        auto pCurJoint = pCurrentJointStream->GetLastJoint();
 
-        auto oCurJointPos  = pCurJoint->GetPosition();
+void cHierarchicMotion::Append(std::int64_t nTime, const float* pPositions)
+{
+    // frame 0 is the calibrated pose, neither a predecessor nor part of the filtered stream
+    std::size_t nLast = m_oFrames.Size() - 1;
+    std::int64_t nDelta = (nLast > 0) ? nTime - m_oFrames.Time(nLast) : 0;
+
+    // the time unit of a recording is unknown, the step of the sensor clock is one frame
+    double fFrames = (nDelta > 0) ? nDelta / FrameStep() : 0.0;
+
+    const float* pStored = pPositions;
+    if (m_pFilter)
+    {
+        m_pFilter->Filter(fFrames / m_fFrameRate, pPositions, m_aFiltered);
+        pStored = m_aFiltered;
+    }
+
+    // frames rejected in between are replaced by a straight line from the last stored frame
+    long nMissing = static_cast<long>(std::floor(fFrames + 0.5)) - 1;
+    if (nLast > 0 && nMissing > 0 && nMissing <= static_cast<long>(m_nMaxGapFrames))
+    {
+        float aFrom[cFrameArena::nColumns];
+        float aGap[cFrameArena::nColumns];
+        for (std::size_t nColumn=0; nColumn<cFrameArena::nColumns; ++nColumn)
+        {
+            aFrom[nColumn] = m_oFrames.Value(nColumn, nLast);
+        }
 
-        for (auto pSubJointStream : pCurrentJointStream->m_oSubJointStream)
+        std::int64_t nFrom = m_oFrames.Time(nLast);
+        for (long nStep=1; nStep<=nMissing; ++nStep)
         {
-            auto pSubJoint = pSubJointStream->GetLastJoint();
-            auto oSubJointPos  = pSubJoint->GetPosition();
-
-            auto oOffset = oCurJointPos-oSubJointPos;
-            auto fCurLimbLength = oOffset.Magnitude();
-            auto fLimbLength = pSubJointStream->GetLimbLength();
-
-            pSubJoint->SetOffset(oCurJointPos-oSubJointPos);
-
-            if (!EQPercentageDiff(static_cast<double>(fLimbLength),
-                                  static_cast<double>(fCurLimbLength), 0.3f)
-                && pSubJointStream->GetType() != JT_HandLeft
-                && pSubJointStream->GetType() != JT_HandTipLeft
-                && pSubJointStream->GetType() != JT_HandRight
-                && pSubJointStream->GetType() != JT_HandTipRight
-                && pSubJointStream->GetType() != JT_ThumbLeft
-                && pSubJointStream->GetType() != JT_ThumbRight
-                && pSubJointStream->GetType() != JT_FootLeft
-                && pSubJointStream->GetType() != JT_FootRight
-                && pSubJointStream->GetType() != JT_Head)
+            float fWeight = static_cast<float>(nStep) / (nMissing + 1);
+            for (std::size_t nColumn=0; nColumn<cFrameArena::nColumns; ++nColumn)
             {
+                aGap[nColumn] = aFrom[nColumn] + fWeight * (pStored[nColumn] - aFrom[nColumn]);
+            }
+            m_oFrames.PushBack(nFrom + nDelta * nStep / (nMissing + 1), aGap);
+        }
+        m_oStats.AddInterpolated(static_cast<std::size_t>(nMissing));
+    }
 
-                std::cout << pSubJointStream->GetName()
-                          << " (" << fabs(fLimbLength - fCurLimbLength) << ")"
-                          << " dont fit" << std::endl;
+    m_oFrames.PushBack(nTime, pStored);
+}
 
-                RemoveLastJointSet();
-                return;
+
+std::size_t cHierarchicMotion::ExtendMotion(const cSkeletonFrames& oFrames, std::size_t nFirst)
+{
+    if (nFirst >= oFrames.Size())
+    {
+        return 0;
+    }
+
+    std::size_t nCount = oFrames.Size() - nFirst;
+    m_oValidator.Validate(oFrames, nFirst, nCount, m_vecAccepted);
+
+    std::size_t nAdded = 0;
+    std::int64_t nLastTime = m_oFrames.Empty() ? 0 : m_oFrames.Time(m_oFrames.Size() - 1);
+    float aPositions[cFrameArena::nColumns];
+    eJointType eBone;
+    double fDeviation;
+    for (std::size_t i=0; i<nCount; ++i)
+    {
+        std::size_t nFrame = nFirst + i;
+        if (oFrames.Time(nFrame) == 0)
+        {
+            m_oStats.AddWithoutTime();
+            continue;
+        }
+        AddTimestamp(oFrames.Time(nFrame));
+        if (!cFrameValidator::IsAccepted(m_vecAccepted, i))
+        {
+            // only the rejected frames are checked again, to find out why
+            if (m_oValidator.Check(oFrames, nFrame, eBone, fDeviation) == cFrameValidator::FV_COLLAPSED)
+            {
+                m_oStats.AddCollapsed();
             }
+            else
+            {
+                m_oStats.AddLimbMismatch(eBone, fDeviation);
+            }
+            continue;
         }
-    }
+        if (oFrames.Time(nFrame) < nLastTime)
+        {
+            m_oStats.AddOutOfOrder();
+            continue;
+        }
+        nLastTime = oFrames.Time(nFrame);
 
-    std::cout << "Es passt mal was!!!!!! ... quasi" << std::endl;
+        for (std::size_t nColumn=0; nColumn<cFrameArena::nColumns; ++nColumn)
+        {
+            aPositions[nColumn] = oFrames.Column(nColumn)[nFrame];
+        }
+        Append(oFrames.Time(nFrame), aPositions);
+        ++nAdded;
+    }
+    m_oStats.AddAccepted(nAdded);
+    return nAdded;
 }
 
 
@@ -245,18 +320,38 @@ bool cHierarchicMotion::Initialized()
 }
 
 
-std::vector<std::vector<cJoint>> cHierarchicMotion::GetJoints()
+unsigned long cHierarchicMotion::Size()
 {
-    std::vector<std::vector<cJoint>> vecOfJointVecs;
-    for (int i=0; i<JT_Count; ++i)
-    {
-        std::vector<cJoint> vecJoint;
-        auto eType = static_cast<eJointType>(i);
-        for (std::shared_ptr<cJoint> pJoint : *m_mapJointStreams[eType])
-        {
-            vecJoint.push_back(*pJoint);
-        }
-        vecOfJointVecs.push_back(vecJoint);
-    }
-    return vecOfJointVecs;
+    return m_oFrames.Size();
+}
+
+
+std::int64_t cHierarchicMotion::GetTime(unsigned long nId)
+{
+    return m_oFrames.Time(nId);
+}
+
+
+const cFrameArena& cHierarchicMotion::Frames() const
+{
+    return m_oFrames;
+}
+
+
+void cHierarchicMotion::GetFrames(cSkeletonFrames& oFrames)
+{
+    // the calibrated pose has no timestamp of its own and keeps 0
+    m_oFrames.CopyTo(oFrames);
+}
+
+
+const cValidationStats& cHierarchicMotion::Statistics() const
+{
+    return m_oStats;
+}
+
+
+float cHierarchicMotion::GetLimbLength(eJointType eType)
+{
+    return m_aLimbLengths[eType];
 }
@@ -1,25 +1,67 @@
 #ifndef CHIERARCHICMOTION_H
 #define CHIERARCHICMOTION_H
 
-#include "jointstream.h"
+#include "skeletonframes.h"
+#include "framearena.h"
+#include "skeletontopology.h"
+#include "p2quantile.h"
+#include "framevalidator.h"
+#include "validationstats.h"
+#include "framefilter.h"
 
 #include "joint.h"
 #include "helper.h"
 
-#include <map>
 #include <vector>
-#include <iostream>
-
-
+#include <memory>
+#include <string>
+
+
+/* Motion of one skeleton. The first frames calibrate the limb lengths
+ * (streaming median over a window of CalibrationFrames() frames, the frames
+ * themselves are not kept), every later frame is only kept if its limbs
+ * match the calibration. A frame is passed as JT_Count * 3 floats, x/y/z per
+ * joint in eJointType order; accepted frames are stored in a cFrameArena,
+ * the first one being the calibrated pose (median per coordinate, time 0).
+ * Frames that are older than the last accepted one are dropped, so the
+ * stored frames are ordered by time and can be searched with
+ * cFrameArena::LowerBound/UpperBound. */
 class cHierarchicMotion
 {
 public:
   cHierarchicMotion();
 
-  void Init(std::vector<std::shared_ptr<cJoint>> pJoints);
-  void ExtendMotion(std::int64_t nTime, std::vector<std::shared_ptr<cJoint>> oJoints);
-
-  std::vector<std::vector<cJoint>> GetJoints();
+  // only has an effect before the calibration is done
+  void SetCalibrationFrames(unsigned nFrames);
+  unsigned CalibrationFrames() const;
+
+  // optional stage for the accepted frames before they are stored: pFilter
+  // smoothes them, gaps of up to nMaxGapFrames rejected frames are filled by
+  // linear interpolation; fFrameRate of the sensor converts frame steps to seconds
+  void SetFilter(std::shared_ptr<cFrameFilter> pFilter, unsigned nMaxGapFrames, float fFrameRate = 30.0f);
+  // the filter settings in text form, empty without filter stage
+  std::string FilterDescription() const;
+
+  // frames are validated before anything is stored; nothing is logged, what
+  // happened to every frame is counted in Statistics()
+  void Init(std::int64_t nTime, const float* pPositions);
+  void ExtendMotion(std::int64_t nTime, const float* pPositions);
+  // validates the frames [nFirst, oFrames.Size()) as one batch and appends the
+  // accepted ones, frames without timestamp or out of order are skipped;
+  // returns how many were added
+  std::size_t ExtendMotion(const cSkeletonFrames& oFrames, std::size_t nFirst);
+
+  // one sensor frame in the time unit of the recording: median step between
+  // the timestamps of all rows passed so far, rejected ones included, since
+  // the sensor clock runs on whether a frame is kept or not; 0 before two rows
+  double FrameStep() const;
+
+  const cFrameArena& Frames() const;
+  // accepted frames in struct-of-arrays form
+  void GetFrames(cSkeletonFrames& oFrames);
+  // calibrated length of the bone that ends in the given joint
+  float GetLimbLength(eJointType eType);
+  const cValidationStats& Statistics() const;
 
   std::int64_t GetTime(unsigned long nId);
 
@@ -29,19 +71,36 @@ public:
 
 private:
   bool m_bInit;
-  const unsigned nNumberOfInitSets = 50;
+  unsigned m_nCalibrationFrames;
   unsigned m_nInitCallCounter;
-  cVector3<float> m_oPosition;
 
-  std::map<eJointType, std::shared_ptr<cJointStream>> m_mapJointStreams;
-  std::shared_ptr<std::vector<std::int64_t>> m_vecTimeStream;
+  cFrameArena m_oFrames;
+  // calibrated length of the bone that ends in a joint, 0 for the root
+  float m_aLimbLengths[JT_Count];
+
+  cP2Quantile m_aLimbEstimators[JT_Count];
+  cP2Quantile m_aPoseEstimators[cFrameArena::nColumns];
+
+  cFrameValidator m_oValidator;
+  std::vector<std::uint64_t> m_vecAccepted;
+  cValidationStats m_oStats;
+
+  std::shared_ptr<cFrameFilter> m_pFilter;
+  unsigned m_nMaxGapFrames;
+  float m_fFrameRate;
+  cP2Quantile m_oFrameInterval;
+  std::int64_t m_nLastTimestamp;
+  float m_aFiltered[cFrameArena::nColumns];
 
-  void AddJointSet(std::vector<std::shared_ptr<cJoint>> vecJoints);
-  void RemoveLastJointSet();
+  // feeds m_oFrameInterval, for every row with a timestamp
+  void AddTimestamp(std::int64_t nTime);
+  // filter stage and gap filling, then storage
+  void Append(std::int64_t nTime, const float* pPositions);
 
-  void BuildHierarchy();
+  // on failure the first bone that does not fit and its relative deviation
+  bool LimbsFit(const float* pPositions, eJointType& eBone, double& fDeviation);
 
-  bool Zero(std::vector<std::shared_ptr<cJoint>>& oJoints);
+  bool Zero(const float* pPositions);
 };
 
 #endif // CHIERARCHICMOTION_H
@@ -1,5 +1,73 @@
 #include "joint.h"
 
+#include <cstring>
+
+
+namespace
+{
+    const char* aJointTypeNames[JT_Count] = {
+        "SpineBase",
+        "SpineMid",
+        "Neck",
+        "Head",
+        "ShoulderLeft",
+        "ElbowLeft",
+        "WristLeft",
+        "HandLeft",
+        "ShoulderRight",
+        "ElbowRight",
+        "WristRight",
+        "HandRight",
+        "HipLeft",
+        "KneeLeft",
+        "AnkleLeft",
+        "FootLeft",
+        "HipRight",
+        "KneeRight",
+        "AnkleRight",
+        "FootRight",
+        "SpineShoulder",
+        "HandTipLeft",
+        "ThumbLeft",
+        "HandTipRight",
+        "ThumbRight"
+    };
+
+
+    bool NameEquals(const char* pBegin, const char* pEnd, const char* sName)
+    {
+        std::size_t nSize = static_cast<std::size_t>(pEnd - pBegin);
+        return (strlen(sName) == nSize) && (strncmp(pBegin, sName, nSize) == 0);
+    }
+}
+
+
+const char* JointTypeName(eJointType eType)
+{
+    return aJointTypeNames[eType];
+}
+
+
+bool JointTypeFromName(const char* pBegin, const char* pEnd, eJointType& eType)
+{
+    for (int i=0; i<JT_Count; ++i)
+    {
+        if (NameEquals(pBegin, pEnd, aJointTypeNames[i]))
+        {
+            eType = static_cast<eJointType>(i);
+            return true;
+        }
+    }
+
+    if (NameEquals(pBegin, pEnd, "Nec"))
+    {
+        eType = JT_Neck;
+        return true;
+    }
+
+    return false;
+}
+
 
 cJoint::cJoint(eJointType eJointType, cVector3<float> oPosition) :
     m_eJointType(eJointType),
@@ -14,6 +82,12 @@ cVector3<float>& cJoint::GetPosition()
 }
 
 
+std::string cJoint::GetTypeName()
+{
+    return JointTypeName(m_eJointType);
+}
+
+
 eJointType cJoint::GetType()
 {
     return m_eJointType;
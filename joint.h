@@ -44,6 +44,12 @@ enum eJointType
 };
 
 
+// name of a joint type as used in the recordings ("SpineBase", "HandLeft", ...)
+const char* JointTypeName(eJointType eType);
+// inverse of JointTypeName, also accepts "Nec" that older recordings use for the neck
+bool JointTypeFromName(const char* pBegin, const char* pEnd, eJointType& eType);
+
+
 class cJoint
 {
 public:
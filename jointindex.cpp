@@ -0,0 +1,359 @@
+#include "jointindex.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+
+cJointIndex::cJointIndex() :
+    m_fCellSize(0.1f),
+    m_fInverseCellSize(10.0f),
+    m_nFrames(0)
+{
+    Clear();
+}
+
+
+void cJointIndex::Clear()
+{
+    m_nFrames = 0;
+    for (int i=0; i<JT_Count; ++i)
+    {
+        sJointGrid& oGrid = m_aGrids[i];
+        oGrid.vecOffsets.assign(2, 0);
+        oGrid.vecEntries.clear();
+        oGrid.vecShared.assign(1, 0);
+        oGrid.nMask = 0;
+        for (int nAxis=0; nAxis<3; ++nAxis)
+        {
+            // empty box, no shell touches it
+            oGrid.aMinCell[nAxis] = 0;
+            oGrid.aMaxCell[nAxis] = -1;
+        }
+    }
+}
+
+
+std::size_t cJointIndex::Size() const
+{
+    return m_nFrames;
+}
+
+
+void cJointIndex::Build(cKinectCSV& oKinect, float fCellSize, unsigned nThreads)
+{
+    Clear();
+    m_fCellSize = (fCellSize > 0.0f) ? fCellSize : 0.1f;
+    m_fInverseCellSize = 1.0f / m_fCellSize;
+    m_nFrames = oKinect.Size();
+    if (m_nFrames < 2)
+    {
+        return;
+    }
+
+    ParallelFor(0, JT_Count, [&](std::size_t nJoint)
+    {
+        std::vector<cVector3<float>> vecPositions(m_nFrames - 1);
+        oKinect.ExportJoint(static_cast<eJointType>(nJoint), 1, m_nFrames, vecPositions.data());
+        BuildGrid(m_aGrids[nJoint], vecPositions);
+    }, nThreads);
+}
+
+
+int cJointIndex::Cell(float fCoordinate) const
+{
+    // far outside of any wall, keeps the cell coordinates and the shells small
+    float fCell = std::floor(fCoordinate * m_fInverseCellSize);
+    fCell = (fCell < -1e6f) ? -1e6f : (fCell > 1e6f) ? 1e6f : fCell;
+    return static_cast<int>(fCell);
+}
+
+
+std::uint32_t cJointIndex::Bucket(int nX, int nY, int nZ, std::uint32_t nMask)
+{
+    return (static_cast<std::uint32_t>(nX) * 73856093u
+            ^ static_cast<std::uint32_t>(nY) * 19349663u
+            ^ static_cast<std::uint32_t>(nZ) * 83492791u) & nMask;
+}
+
+
+void cJointIndex::BuildGrid(sJointGrid& oGrid, const std::vector<cVector3<float>>& vecPositions)
+{
+    // about one bucket per frame, a joint rarely visits that many cells
+    std::size_t nEntries = vecPositions.size();
+    std::uint32_t nBuckets = 64;
+    while (nBuckets < nEntries && nBuckets < (1u << 30))
+    {
+        nBuckets <<= 1;
+    }
+    oGrid.nMask = nBuckets - 1;
+
+    std::vector<std::uint32_t> vecBuckets(nEntries);
+    oGrid.vecOffsets.assign(nBuckets + 1, 0);
+    oGrid.vecShared.assign(nBuckets, 0);
+    // the first cell seen in every bucket, to tell which buckets are shared
+    std::vector<int> vecFirstCell(nBuckets * 3);
+    for (int nAxis=0; nAxis<3; ++nAxis)
+    {
+        oGrid.aMinCell[nAxis] = Cell(vecPositions[0][nAxis]);
+        oGrid.aMaxCell[nAxis] = oGrid.aMinCell[nAxis];
+    }
+    for (std::size_t i=0; i<nEntries; ++i)
+    {
+        int aCell[3];
+        for (int nAxis=0; nAxis<3; ++nAxis)
+        {
+            aCell[nAxis] = Cell(vecPositions[i][nAxis]);
+            oGrid.aMinCell[nAxis] = std::min(oGrid.aMinCell[nAxis], aCell[nAxis]);
+            oGrid.aMaxCell[nAxis] = std::max(oGrid.aMaxCell[nAxis], aCell[nAxis]);
+        }
+        std::uint32_t nBucket = Bucket(aCell[0], aCell[1], aCell[2], oGrid.nMask);
+        vecBuckets[i] = nBucket;
+        int* pFirstCell = vecFirstCell.data() + nBucket * 3;
+        if (oGrid.vecOffsets[nBucket + 1]++ == 0)
+        {
+            std::copy(aCell, aCell + 3, pFirstCell);
+        }
+        else if (!std::equal(aCell, aCell + 3, pFirstCell))
+        {
+            oGrid.vecShared[nBucket] = 1;
+        }
+    }
+    for (std::uint32_t b=0; b<nBuckets; ++b)
+    {
+        oGrid.vecOffsets[b + 1] += oGrid.vecOffsets[b];
+    }
+
+    // frames go in in order, so every bucket ends up sorted by frame
+    std::vector<std::uint32_t> vecFill(oGrid.vecOffsets.begin(), oGrid.vecOffsets.end() - 1);
+    oGrid.vecEntries.resize(nEntries);
+    for (std::size_t i=0; i<nEntries; ++i)
+    {
+        sEntry& oEntry = oGrid.vecEntries[vecFill[vecBuckets[i]]++];
+        oEntry.aPosition[0] = vecPositions[i][0];
+        oEntry.aPosition[1] = vecPositions[i][1];
+        oEntry.aPosition[2] = vecPositions[i][2];
+        oEntry.nFrame = static_cast<std::uint32_t>(i + 1);
+    }
+}
+
+
+bool cJointIndex::InCell(const sEntry& oEntry, int nX, int nY, int nZ) const
+{
+    return Cell(oEntry.aPosition[0]) == nX && Cell(oEntry.aPosition[1]) == nY
+        && Cell(oEntry.aPosition[2]) == nZ;
+}
+
+
+template<class F>
+void cJointIndex::VisitCell(const sJointGrid& oGrid, int nX, int nY, int nZ,
+                            std::size_t nFirst, std::size_t nEnd, F oVisit) const
+{
+    std::uint32_t nBucket = Bucket(nX, nY, nZ, oGrid.nMask);
+    const sEntry* pBegin = oGrid.vecEntries.data() + oGrid.vecOffsets[nBucket];
+    const sEntry* pEnd = oGrid.vecEntries.data() + oGrid.vecOffsets[nBucket + 1];
+    const sEntry* pEntry = std::lower_bound(pBegin, pEnd, nFirst, [](const sEntry& oEntry, std::size_t nFrame)
+    {
+        return oEntry.nFrame < nFrame;
+    });
+
+    if (pEntry == pEnd)
+    {
+        return;
+    }
+
+    // other cells may share the bucket, if not one entry tells whether it holds this cell
+    bool bShared = oGrid.vecShared[nBucket] != 0;
+    if (!bShared && !InCell(*pEntry, nX, nY, nZ))
+    {
+        return;
+    }
+    for (; pEntry<pEnd && pEntry->nFrame<nEnd; ++pEntry)
+    {
+        if (!bShared || InCell(*pEntry, nX, nY, nZ))
+        {
+            oVisit(*pEntry);
+        }
+    }
+}
+
+
+void cJointIndex::Radius(eJointType eType, const cVector3<float>& oCenter, float fRadius,
+                         std::vector<sHit>& vecHits, std::size_t nFirst, std::size_t nEnd) const
+{
+    vecHits.clear();
+    if (eType < 0 || eType >= JT_Count || fRadius < 0.0f)
+    {
+        return;
+    }
+    const sJointGrid& oGrid = m_aGrids[eType];
+    if (oGrid.vecEntries.empty())
+    {
+        return;
+    }
+    nFirst = std::max<std::size_t>(nFirst, 1);
+    nEnd = std::min(nEnd, m_nFrames);
+
+    int aFrom[3];
+    int aTo[3];
+    for (int nAxis=0; nAxis<3; ++nAxis)
+    {
+        aFrom[nAxis] = std::max(Cell(oCenter[nAxis] - fRadius), oGrid.aMinCell[nAxis]);
+        aTo[nAxis] = std::min(Cell(oCenter[nAxis] + fRadius), oGrid.aMaxCell[nAxis]);
+    }
+
+    float fRadius2 = fRadius * fRadius;
+    auto oVisit = [&](const sEntry& oEntry)
+    {
+        float fX = oEntry.aPosition[0] - oCenter[0];
+        float fY = oEntry.aPosition[1] - oCenter[1];
+        float fZ = oEntry.aPosition[2] - oCenter[2];
+        float fDistance2 = fX * fX + fY * fY + fZ * fZ;
+        if (fDistance2 <= fRadius2)
+        {
+            vecHits.push_back({oEntry.nFrame, std::sqrt(fDistance2)});
+        }
+    };
+    for (int nX=aFrom[0]; nX<=aTo[0]; ++nX)
+    {
+        for (int nY=aFrom[1]; nY<=aTo[1]; ++nY)
+        {
+            for (int nZ=aFrom[2]; nZ<=aTo[2]; ++nZ)
+            {
+                VisitCell(oGrid, nX, nY, nZ, nFirst, nEnd, oVisit);
+            }
+        }
+    }
+
+    std::sort(vecHits.begin(), vecHits.end(), [](const sHit& oA, const sHit& oB)
+    {
+        return oA.nFrame < oB.nFrame;
+    });
+}
+
+
+void cJointIndex::Nearest(eJointType eType, const cVector3<float>& oCenter, std::size_t nCount,
+                          std::vector<sHit>& vecHits, std::size_t nFirst, std::size_t nEnd) const
+{
+    vecHits.clear();
+    if (eType < 0 || eType >= JT_Count || nCount == 0)
+    {
+        return;
+    }
+    const sJointGrid& oGrid = m_aGrids[eType];
+    if (oGrid.vecEntries.empty())
+    {
+        return;
+    }
+    nFirst = std::max<std::size_t>(nFirst, 1);
+    nEnd = std::min(nEnd, m_nFrames);
+
+    // the best nCount so far as a max heap, fDistance is squared until the end
+    auto oFarther = [](const sHit& oA, const sHit& oB)
+    {
+        return oA.fDistance < oB.fDistance;
+    };
+    auto oVisit = [&](const sEntry& oEntry)
+    {
+        float fX = oEntry.aPosition[0] - oCenter[0];
+        float fY = oEntry.aPosition[1] - oCenter[1];
+        float fZ = oEntry.aPosition[2] - oCenter[2];
+        sHit oHit = {oEntry.nFrame, fX * fX + fY * fY + fZ * fZ};
+        if (vecHits.size() < nCount)
+        {
+            vecHits.push_back(oHit);
+            std::push_heap(vecHits.begin(), vecHits.end(), oFarther);
+        }
+        else if (oHit.fDistance < vecHits.front().fDistance)
+        {
+            std::pop_heap(vecHits.begin(), vecHits.end(), oFarther);
+            vecHits.back() = oHit;
+            std::push_heap(vecHits.begin(), vecHits.end(), oFarther);
+        }
+    };
+
+    // squared distance from the center to the nearest point of a cell
+    auto oCellDistance = [&](int nX, int nY, int nZ)
+    {
+        int aCell[3] = {nX, nY, nZ};
+        float fDistance2 = 0.0f;
+        for (int nAxis=0; nAxis<3; ++nAxis)
+        {
+            float fBelow = aCell[nAxis] * m_fCellSize - oCenter[nAxis];
+            float fAbove = oCenter[nAxis] - (aCell[nAxis] + 1) * m_fCellSize;
+            float fAxis = std::max(0.0f, std::max(fBelow, fAbove));
+            fDistance2 += fAxis * fAxis;
+        }
+        return fDistance2;
+    };
+    auto oShellCell = [&](int nX, int nY, int nZ)
+    {
+        if (vecHits.size() < nCount || oCellDistance(nX, nY, nZ) < vecHits.front().fDistance)
+        {
+            VisitCell(oGrid, nX, nY, nZ, nFirst, nEnd, oVisit);
+        }
+    };
+
+    // shells of cells around the center, r cells away along the farthest axis
+    int aCenter[3];
+    int nLastShell = -1;
+    for (int nAxis=0; nAxis<3; ++nAxis)
+    {
+        aCenter[nAxis] = Cell(oCenter[nAxis]);
+        nLastShell = std::max(nLastShell, std::max(std::abs(aCenter[nAxis] - oGrid.aMinCell[nAxis]),
+                                                   std::abs(oGrid.aMaxCell[nAxis] - aCenter[nAxis])));
+    }
+    for (int r=0; r<=nLastShell; ++r)
+    {
+        int nFromX = std::max(aCenter[0] - r, oGrid.aMinCell[0]);
+        int nToX = std::min(aCenter[0] + r, oGrid.aMaxCell[0]);
+        int nFromY = std::max(aCenter[1] - r, oGrid.aMinCell[1]);
+        int nToY = std::min(aCenter[1] + r, oGrid.aMaxCell[1]);
+        int nFromZ = std::max(aCenter[2] - r, oGrid.aMinCell[2]);
+        int nToZ = std::min(aCenter[2] + r, oGrid.aMaxCell[2]);
+        for (int nX=nFromX; nX<=nToX; ++nX)
+        {
+            for (int nY=nFromY; nY<=nToY; ++nY)
+            {
+                if (std::abs(nX - aCenter[0]) == r || std::abs(nY - aCenter[1]) == r)
+                {
+                    for (int nZ=nFromZ; nZ<=nToZ; ++nZ)
+                    {
+                        oShellCell(nX, nY, nZ);
+                    }
+                    continue;
+                }
+                // inside the shell only its bottom and top
+                if (aCenter[2] - r >= oGrid.aMinCell[2])
+                {
+                    oShellCell(nX, nY, aCenter[2] - r);
+                }
+                if (aCenter[2] + r <= oGrid.aMaxCell[2])
+                {
+                    oShellCell(nX, nY, aCenter[2] + r);
+                }
+            }
+        }
+
+        // everything beyond shell r lies outside the cube of the shells so far
+        float fReach = std::numeric_limits<float>::max();
+        for (int nAxis=0; nAxis<3; ++nAxis)
+        {
+            fReach = std::min(fReach, oCenter[nAxis] - (aCenter[nAxis] - r) * m_fCellSize);
+            fReach = std::min(fReach, (aCenter[nAxis] + r + 1) * m_fCellSize - oCenter[nAxis]);
+        }
+        fReach = std::max(fReach, 0.0f);
+        if (vecHits.size() == nCount && vecHits.front().fDistance <= fReach * fReach)
+        {
+            break;
+        }
+    }
+
+    std::sort_heap(vecHits.begin(), vecHits.end(), oFarther);
+    for (sHit& oHit : vecHits)
+    {
+        oHit.fDistance = std::sqrt(oHit.fDistance);
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef CJOINTINDEX_H
+#define CJOINTINDEX_H
+
+#include "kinectcsv.h"
+#include "joint.h"
+#include "vector3.hpp"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+
+/* Spatial index over the positions of every joint in every frame of a
+ * motion, for questions like "in which frames was the left hand within
+ * 10 cm of this hold". Every joint has its own uniform grid of cubic cells,
+ * stored as a hash table in one block: the entries are sorted by bucket,
+ * and within a bucket by frame, so a frame range (see
+ * cKinectCSV::GetTimeRange) is a binary search per visited bucket. Positions
+ * are in the scene, as drawn; the calibrated pose (frame 0) is left out.
+ * The joints are indexed in parallel. */
+class cJointIndex
+{
+public:
+  struct sHit
+  {
+    std::size_t nFrame;
+    float fDistance;
+  };
+
+  cJointIndex();
+
+  // fCellSize in m, about the query radius works best; nThreads == 0 uses all cores
+  void Build(cKinectCSV& oKinect, float fCellSize = 0.1f, unsigned nThreads = 0);
+  void Clear();
+  // frames of the indexed motion, frame 0 included
+  std::size_t Size() const;
+
+  // frames in [nFirst, nEnd) in which the joint was within fRadius of
+  // oCenter, ordered by frame
+  void Radius(eJointType eType, const cVector3<float>& oCenter, float fRadius,
+              std::vector<sHit>& vecHits, std::size_t nFirst = 0, std::size_t nEnd = SIZE_MAX) const;
+  // the nCount frames in [nFirst, nEnd) in which the joint was closest to
+  // oCenter, nearest first
+  void Nearest(eJointType eType, const cVector3<float>& oCenter, std::size_t nCount,
+               std::vector<sHit>& vecHits, std::size_t nFirst = 0, std::size_t nEnd = SIZE_MAX) const;
+
+private:
+  struct sEntry
+  {
+    float aPosition[3];
+    std::uint32_t nFrame;
+  };
+
+  struct sJointGrid
+  {
+    // entries of bucket b are [vecOffsets[b], vecOffsets[b + 1])
+    std::vector<std::uint32_t> vecOffsets;
+    std::vector<sEntry> vecEntries;
+    // 1 for buckets that hold more than one cell
+    std::vector<std::uint8_t> vecShared;
+    std::uint32_t nMask;
+    // cells that hold any entry, bounds of the shell search in Nearest
+    int aMinCell[3];
+    int aMaxCell[3];
+  };
+
+  float m_fCellSize;
+  float m_fInverseCellSize;
+  std::size_t m_nFrames;
+  sJointGrid m_aGrids[JT_Count];
+
+  int Cell(float fCoordinate) const;
+  bool InCell(const sEntry& oEntry, int nX, int nY, int nZ) const;
+  static std::uint32_t Bucket(int nX, int nY, int nZ, std::uint32_t nMask);
+  void BuildGrid(sJointGrid& oGrid, const std::vector<cVector3<float>>& vecPositions);
+
+  // calls oVisit(oEntry) for the entries of the cell in the frame range
+  template<class F>
+  void VisitCell(const sJointGrid& oGrid, int nX, int nY, int nZ,
+                 std::size_t nFirst, std::size_t nEnd, F oVisit) const;
+};
+
+#endif // CJOINTINDEX_H
@@ -1,70 +1,489 @@
 #include "kinectcsv.h"
+#include "mappedfile.h"
+#include "gzipreader.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+cKinectCSV::cKinectCSV() :
+  m_nThreads(1),
+  m_nCalibrationFrames(50),
+  m_nMaxGapFrames(0),
+  m_fFrameRate(30.0f),
+  m_nOffset(0)
+{
+}
+
+
+void cKinectCSV::SetThreadCount(unsigned nThreads)
+{
+  m_nThreads = nThreads;
+}
+
+
+void cKinectCSV::SetCalibrationFrames(unsigned nFrames)
+{
+  m_nCalibrationFrames = nFrames;
+}
+
+
+void cKinectCSV::SetFilter(std::shared_ptr<cFrameFilter> pFilter, unsigned nMaxGapFrames, float fFrameRate)
+{
+  m_pFilter = pFilter;
+  m_nMaxGapFrames = nMaxGapFrames;
+  m_fFrameRate = fFrameRate;
+}
 
 
 void cKinectCSV::LoadFromFile(const string& sFilename)
+{
+  Reset(sFilename);
+  if (cGzipReader::IsCompressed(sFilename))
+  {
+      ReadCompressedRows();
+  }
+  else
+  {
+      ReadAppendedRows(false);
+  }
+}
+
+
+void cKinectCSV::Follow(const string& sFilename)
+{
+  Reset(sFilename);
+  if (cGzipReader::IsCompressed(sFilename))
+  {
+      ReadCompressedRows();
+  }
+  else
+  {
+      ReadAppendedRows(true);
+  }
+}
+
+
+std::size_t cKinectCSV::Update()
+{
+  // a compressed recording cannot be continued at a byte offset, Follow read all of it
+  if (cGzipReader::IsCompressed(m_sFilename))
+  {
+      return 0;
+  }
+  return ReadAppendedRows(true);
+}
+
+
+void cKinectCSV::Reset(const string& sFilename)
 {
   m_pHierarchicMotion = std::make_shared<cHierarchicMotion>(); // TODO: move to constructor
+  m_pHierarchicMotion->SetCalibrationFrames(m_nCalibrationFrames);
+  m_pHierarchicMotion->SetFilter(m_pFilter, m_nMaxGapFrames, m_fFrameRate);
+  m_oFrames.Clear();
+  m_oCache.Close();
+  m_oParser = cSkeletonCSVParser();
+  m_sFilename = sFilename;
+  m_nOffset = 0;
+}
+
 
-  std::ifstream oFile(sFilename);
-  std::vector<std::shared_ptr<cJoint>> oJoints;
-  for(cCSVIterator oRow(oFile); oRow != cCSVIterator(); ++oRow) // per line
+std::size_t cKinectCSV::ReadAppendedRows(bool bCompleteRowsOnly)
+{
+  // mapping is lazy, only the pages behind the offset are actually read
+  cMappedFile oFile;
+  if (!oFile.Open(m_sFilename))
   {
-      GetJointsFromRow((*oRow), oJoints);
-      std::int64_t nTime = SToLL((*oRow)[0]);
+      throw fileNotFound();
+  }
 
-      if (nTime == 0) continue;
+  // file got shorter: the recorder started a new one, begin from scratch
+  if (oFile.Size() < m_nOffset)
+  {
+      Reset(m_sFilename);
+  }
 
-      if (!m_pHierarchicMotion->Initialized())
+  const char* pBegin = oFile.Begin() + m_nOffset;
+  const char* pEnd = oFile.End();
+
+  // a row the recorder is still writing is picked up by the next update
+  if (bCompleteRowsOnly)
+  {
+      while (pEnd > pBegin && *(pEnd - 1) != '\n')
       {
-          m_pHierarchicMotion->Init(oJoints);
+          --pEnd;
       }
-      else
+  }
+
+  if (pEnd == pBegin)
+  {
+      return 0;
+  }
+
+  // the parser keeps the schema of the header row for appended rows
+  std::size_t nRows = (m_nThreads == 1) ? m_oParser.Parse(pBegin, pEnd, m_oFrames)
+                                        : m_oParser.ParseParallel(pBegin, pEnd, m_oFrames, m_nThreads);
+  m_nOffset = static_cast<std::size_t>(pEnd - oFile.Begin());
+
+  FeedFrames();
+  return nRows;
+}
+
+
+std::size_t cKinectCSV::ReadCompressedRows()
+{
+  // rows are parsed and fed to the motion chunk by chunk while the next chunk
+  // is inflated, the whole recording is never held decompressed
+  std::string sCarry;
+  std::size_t nRows = 0;
+
+  cGzipReader oReader;
+  cGzipReader::eError eError = oReader.Read(m_sFilename, [&](const char* pBegin, const char* pEnd)
+  {
+      // the part behind the last line break belongs to the next chunk
+      const char* pLastLine = pEnd;
+      while (pLastLine > pBegin && *(pLastLine - 1) != '\n')
       {
-          m_pHierarchicMotion->ExtendMotion(nTime, oJoints);
+          --pLastLine;
       }
+
+      if (pLastLine == pBegin)
+      {
+          sCarry.append(pBegin, pEnd);
+          return;
+      }
+
+      if (!sCarry.empty())
+      {
+          const char* pFirstLineEnd = static_cast<const char*>(memchr(pBegin, '\n', pLastLine - pBegin)) + 1;
+          sCarry.append(pBegin, pFirstLineEnd);
+          nRows += m_oParser.Parse(sCarry.data(), sCarry.data() + sCarry.size(), m_oFrames);
+          sCarry.clear();
+          pBegin = pFirstLineEnd;
+      }
+
+      nRows += m_oParser.Parse(pBegin, pLastLine, m_oFrames);
+      sCarry.assign(pLastLine, pEnd);
+      FeedFrames();
+  });
+
+  if (eError == cGzipReader::GZ_OPEN)
+  {
+      throw fileNotFound();
+  }
+  if (eError != cGzipReader::GZ_OK)
+  {
+      throw corruptFile();
   }
+
+  // last row without a line break
+  if (!sCarry.empty())
+  {
+      nRows += m_oParser.Parse(sCarry.data(), sCarry.data() + sCarry.size(), m_oFrames);
+      FeedFrames();
+  }
+  return nRows;
 }
 
 
-void cKinectCSV::GetJointsFromRow(cCSVRow oRow, std::vector<std::shared_ptr<cJoint>>& oJoints)
+void cKinectCSV::FeedFrames()
 {
-  oJoints.clear();
+  // position relative to camera
+  for (int i=0; i<JT_Count; ++i)
+  {
+      float* pX = m_oFrames.Column(static_cast<eJointType>(i), 0);
+      for (size_t nFrame=0; nFrame<m_oFrames.Size(); ++nFrame)
+      {
+          pX[nFrame] = -pX[nFrame];
+      }
+  }
+
+  // the calibration takes the frames one by one, all later ones are validated as a batch
+  size_t nFrame = 0;
+  float aPositions[cSkeletonFrames::nColumns];
+  for (; nFrame<m_oFrames.Size() && !m_pHierarchicMotion->Initialized(); ++nFrame) // per line
+  {
+      GetFrame(nFrame, aPositions);
+      m_pHierarchicMotion->Init(m_oFrames.Time(nFrame), aPositions);
+  }
+
+  m_pHierarchicMotion->ExtendMotion(m_oFrames, nFrame);
 
-  eJointType nJointType;
-  cVector3<float> oPosition{0, 0, 0};
+  // the motion holds everything from here on, keep only the capacity
+  m_oFrames.Clear();
+}
 
-  // iterate through row and create add joints to list
-  for (size_t i=1, counter=0; i<oRow.size()-1; i+=3)
+
+void cKinectCSV::GetFrame(size_t nFrame, float* pPositions)
+{
+  // column order of the recording follows eJointType
+  for (size_t nColumn=0; nColumn<cSkeletonFrames::nColumns; ++nColumn)
   {
-      // type depends on index in row; so we define new type by counting up
-      nJointType = static_cast<eJointType>(counter++);
-      // position relative to camera
-      oPosition[0] = -SToF(oRow[i]);
-      oPosition[1] = SToF(oRow[i+1]);
-      oPosition[2] = SToF(oRow[i+2]);
+      pPositions[nColumn] = m_oFrames.Column(nColumn)[nFrame];
+  }
+}
+
 
-      std::shared_ptr<cJoint> pJoint(new cJoint(nJointType, oPosition));
-      oJoints.push_back(pJoint);
+bool cKinectCSV::LoadFromCache(const string& sFilename, const string& sCacheFile)
+{
+  Reset(sFilename);
+  return m_oCache.Open(sCacheFile, sFilename, m_nCalibrationFrames, m_pHierarchicMotion->FilterDescription());
+}
+
+
+bool cKinectCSV::WriteCache(const string& sCacheFile)
+{
+  float aLimbLengths[JT_Count];
+  for (int i=0; i<JT_Count; ++i)
+  {
+      aLimbLengths[i] = m_pHierarchicMotion->GetLimbLength(static_cast<eJointType>(i));
   }
+
+  cSkeletonFrames oAccepted;
+  m_pHierarchicMotion->GetFrames(oAccepted);
+  return cMotionCache::Write(sCacheFile, m_sFilename, oAccepted, aLimbLengths, m_pHierarchicMotion->FrameStep(),
+                             m_nCalibrationFrames,
+                             m_pHierarchicMotion->FilterDescription());
+}
+
+
+const cValidationStats& cKinectCSV::Statistics()
+{
+  return m_pHierarchicMotion->Statistics();
+}
+
+
+std::size_t cKinectCSV::Size()
+{
+  return m_oCache.IsOpen() ? m_oCache.Size() : m_pHierarchicMotion->Size();
+}
+
+
+std::int64_t cKinectCSV::GetTime(std::size_t nFrame)
+{
+  return m_oCache.IsOpen() ? m_oCache.Time(nFrame) : m_pHierarchicMotion->GetTime(nFrame);
+}
+
+
+std::size_t cKinectCSV::Bound(std::int64_t nTime, bool bUpper)
+{
+  if (Size() <= 1)
+  {
+      return Size();
+  }
+
+  if (m_oCache.IsOpen())
+  {
+      const std::int64_t* pBegin = m_oCache.TimeColumn() + 1;
+      const std::int64_t* pEnd = m_oCache.TimeColumn() + m_oCache.Size();
+      const std::int64_t* pBound = bUpper ? std::upper_bound(pBegin, pEnd, nTime)
+                                          : std::lower_bound(pBegin, pEnd, nTime);
+      return static_cast<std::size_t>(pBound - m_oCache.TimeColumn());
+  }
+
+  const cFrameArena& oFrames = m_pHierarchicMotion->Frames();
+  return bUpper ? oFrames.UpperBound(nTime, 1) : oFrames.LowerBound(nTime, 1);
+}
+
+
+std::size_t cKinectCSV::SeekTime(std::int64_t nTime)
+{
+  return Bound(nTime, false);
+}
+
+
+std::size_t cKinectCSV::NearestFrame(std::int64_t nTime)
+{
+  std::size_t nFrame = Bound(nTime, false);
+  if (Size() <= 1)
+  {
+      return Size();
+  }
+  if (nFrame == Size())
+  {
+      return nFrame - 1;
+  }
+
+  // the frame before the bound may be closer, unless it is the calibrated pose
+  if (nFrame > 1 && nTime - GetTime(nFrame - 1) <= GetTime(nFrame) - nTime)
+  {
+      return nFrame - 1;
+  }
+  return nFrame;
+}
+
+
+void cKinectCSV::GetTimeRange(std::int64_t nFrom, std::int64_t nTo, std::size_t& nFirst, std::size_t& nEnd)
+{
+  nFirst = Bound(nFrom, false);
+  nEnd = (nTo > nFrom) ? Bound(nTo, false) : nFirst;
+}
+
+
+std::vector<std::vector<cVector3<double>>> cKinectCSV::GetJoints()
+{
+  return GetJoints(0, Size());
 }
 
 
-std::vector<std::vector<fantom::Point3>> cKinectCSV::GetJoints()
+std::vector<std::vector<cVector3<double>>> cKinectCSV::GetJoints(std::size_t nFirst, std::size_t nEnd)
 {
-    std::vector<std::vector<fantom::Point3>> vecJointsAsPoints;
-    std::vector<std::vector<cJoint>> vecJointJoint = m_pHierarchicMotion->GetJoints();
+    nEnd = (nEnd < Size()) ? nEnd : Size();
+    nFirst = (nFirst < nEnd) ? nFirst : nEnd;
 
-    for (std::vector<cJoint> vecJoint : vecJointJoint)
+    std::vector<std::vector<cVector3<double>>> vecJointsAsPoints(JT_Count);
+    for (int i=0; i<JT_Count; ++i)
     {
-        std::vector<fantom::Point3> vecPoints;
-        for (cJoint oJoint : vecJoint)
+        vecJointsAsPoints[i].resize(nEnd - nFirst);
+        ExportJoint(static_cast<eJointType>(i), nFirst, nEnd, vecJointsAsPoints[i].data());
+    }
+    return vecJointsAsPoints;
+}
+
+
+void cKinectCSV::GetKinematics(std::size_t nFirst, std::size_t nEnd, std::vector<sJointKinematics>& vecJoints)
+{
+    nEnd = (nEnd < Size()) ? nEnd : Size();
+    nFirst = (nFirst < nEnd) ? nFirst : nEnd;
+    std::size_t nFrom = (nFirst == 0 && nEnd > 1) ? 1 : nFirst;
+    std::size_t nFrames = nEnd - nFrom;
+
+    std::vector<std::int64_t> vecTime(nFrames);
+    for (std::size_t i=0; i<nFrames; ++i)
+    {
+        vecTime[i] = GetTime(nFrom + i);
+    }
+    double fFrameStep = m_oCache.IsOpen() ? m_oCache.FrameStep() : m_pHierarchicMotion->FrameStep();
+    cKinematics oKinematics;
+    oKinematics.SetTimes(vecTime.data(), nFrames, fFrameStep, m_fFrameRate);
+
+    // one set of columns per worker, the kernel wants each axis contiguous
+    vecJoints.resize(JT_Count);
+    std::size_t nWorkers = m_nThreads ? m_nThreads : HardwareThreads();
+    nWorkers = std::min<std::size_t>(nWorkers, JT_Count);
+    ParallelFor(0, nWorkers, [&](std::size_t nWorker)
+    {
+        std::vector<float> vecX(nFrames);
+        std::vector<float> vecY(nFrames);
+        std::vector<float> vecZ(nFrames);
+        for (std::size_t nJoint=nWorker; nJoint<JT_Count; nJoint+=nWorkers)
         {
-           fantom::Point3 oPoint((-oJoint.GetPosition()[0])+0.05,
-                                 (oJoint.GetPosition()[1]) +0.3,
-                                 (-oJoint.GetPosition()[2]) +0.1);
-           vecPoints.push_back(oPoint);
+            const float* pX;
+            const float* pY;
+            const float* pZ;
+            for (std::size_t i=0; i<nFrames; )
+            {
+                std::size_t nCount = JointColumns(static_cast<eJointType>(nJoint), nFrom + i, pX, pY, pZ);
+                nCount = (nCount < nFrames - i) ? nCount : nFrames - i;
+                std::copy(pX, pX + nCount, vecX.begin() + i);
+                std::copy(pY, pY + nCount, vecY.begin() + i);
+                std::copy(pZ, pZ + nCount, vecZ.begin() + i);
+                i += nCount;
+            }
+
+            sJointKinematics& oJoint = vecJoints[nJoint];
+            std::size_t nOffset = nFrom - nFirst;
+            oJoint.vecSpeed.resize(nEnd - nFirst);
+            oJoint.vecAcceleration.resize(nEnd - nFirst);
+            oJoint.vecJerk.resize(nEnd - nFirst);
+            oKinematics.Compute(vecX.data(), vecY.data(), vecZ.data(), oJoint.vecSpeed.data() + nOffset,
+                                oJoint.vecAcceleration.data() + nOffset, oJoint.vecJerk.data() + nOffset);
+            if (nOffset > 0)
+            {
+                oJoint.vecSpeed[0] = oJoint.vecSpeed[1];
+                oJoint.vecAcceleration[0] = oJoint.vecAcceleration[1];
+                oJoint.vecJerk[0] = oJoint.vecJerk[1];
+            }
         }
-        vecJointsAsPoints.push_back(vecPoints);
+    }, static_cast<unsigned>(nWorkers));
+}
+
+
+void cKinectCSV::GetCompactMotion(cCompactMotion& oMotion)
+{
+    if (!m_oCache.IsOpen())
+    {
+        oMotion.Encode(m_pHierarchicMotion->Frames());
+        return;
     }
-    return vecJointsAsPoints;
+
+    oMotion.Clear();
+    oMotion.Reserve(m_oCache.Size());
+    float aPositions[cFrameArena::nColumns];
+    for (std::size_t nFrame=0; nFrame<m_oCache.Size(); ++nFrame)
+    {
+        for (int i=0; i<JT_Count; ++i)
+        {
+            for (int nAxis=0; nAxis<3; ++nAxis)
+            {
+                aPositions[i * 3 + nAxis] = m_oCache.Column(static_cast<eJointType>(i), nAxis)[nFrame];
+            }
+        }
+        oMotion.PushBack(m_oCache.Time(nFrame), aPositions);
+    }
+}
+
+
+void cKinectCSV::DetectContacts(cContactDetector& oDetector)
+{
+    oDetector.Reset();
+    if (Size() == 0)
+    {
+        return;
+    }
+    oDetector.AddFrame(NULL);
+
+    // only the extremities of the frame are filled in, the detector reads nothing else
+    float aPositions[cFrameArena::nColumns] = {};
+    const float* aColumns[cContactDetector::nExtremities][3];
+    std::size_t nFrame = 1;
+    while (nFrame < Size())
+    {
+        std::size_t nCount = Size() - nFrame;
+        for (std::size_t i=0; i<cContactDetector::nExtremities; ++i)
+        {
+            nCount = std::min(nCount, JointColumns(cContactDetector::aExtremities[i], nFrame,
+                                                   aColumns[i][0], aColumns[i][1], aColumns[i][2]));
+        }
+        for (std::size_t n=0; n<nCount; ++n)
+        {
+            for (std::size_t i=0; i<cContactDetector::nExtremities; ++i)
+            {
+                float* pPosition = aPositions + cContactDetector::aExtremities[i] * 3;
+                pPosition[0] = aColumns[i][0][n];
+                pPosition[1] = aColumns[i][1][n];
+                pPosition[2] = aColumns[i][2][n];
+            }
+            oDetector.AddFrame(aPositions);
+        }
+        nFrame += nCount;
+    }
+}
+
+
+std::size_t cKinectCSV::JointColumns(eJointType eType, std::size_t nFrame,
+                                     const float*& pX, const float*& pY, const float*& pZ)
+{
+    if (nFrame >= Size())
+    {
+        return 0;
+    }
+
+    if (m_oCache.IsOpen())
+    {
+        pX = m_oCache.Column(eType, 0) + nFrame;
+        pY = m_oCache.Column(eType, 1) + nFrame;
+        pZ = m_oCache.Column(eType, 2) + nFrame;
+        return m_oCache.Size() - nFrame;
+    }
+
+    const cFrameArena& oFrames = m_pHierarchicMotion->Frames();
+    std::size_t nChunk = nFrame >> cFrameArena::nChunkShift;
+    std::size_t nOffset = nFrame & (cFrameArena::nChunkFrames - 1);
+    std::size_t nColumn = static_cast<std::size_t>(eType) * 3;
+    pX = oFrames.ChunkColumn(nChunk, nColumn) + nOffset;
+    pY = oFrames.ChunkColumn(nChunk, nColumn + 1) + nOffset;
+    pZ = oFrames.ChunkColumn(nChunk, nColumn + 2) + nOffset;
+    return oFrames.ChunkSize(nChunk) - nOffset;
 }
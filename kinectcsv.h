@@ -1,35 +1,130 @@
 #ifndef CKINECTCSV_H
 #define CKINECTCSV_H
 
-#include "csvreader.h"
+#include "skeletonframes.h"
+#include "skeletonparser.h"
 #include "hierarchicmotion.h"
+#include "motioncache.h"
+#include "compactmotion.h"
+#include "kinematics.h"
+#include "contactdetector.h"
 
 #include "joint.h"
 #include "vector3.hpp"
 
 #include <memory>
 
-#include <fantom/algorithm.hpp>
-#include <fantom/register.hpp>
-#include <fantom/graphics.hpp>
-#include <fantom/fields.hpp>
-
 class cKinectCSV
 {
 public:
+  cKinectCSV();
   virtual ~cKinectCSV() {};
 
+  // threads used to parse a recording, 1 parses on the calling thread, 0 uses all cores
+  void SetThreadCount(unsigned nThreads);
+  // valid frames at the start of a recording that calibrate the limb lengths
+  void SetCalibrationFrames(unsigned nFrames);
+  // filter stage for the accepted frames, see cHierarchicMotion::SetFilter
+  void SetFilter(std::shared_ptr<cFrameFilter> pFilter, unsigned nMaxGapFrames, float fFrameRate = 30.0f);
+
+  // recordings ending in .gz (gzip) or .zz (zlib) are decompressed while they are parsed
   virtual void LoadFromFile(const string& sFilename);
-  std::vector<std::vector<fantom::Point3>> GetJoints();
+
+  // follow mode for recordings that are still being written: Follow loads all
+  // complete rows, every Update parses only the rows appended since then.
+  // Compressed recordings are read completely by Follow, Update adds nothing
+  void Follow(const string& sFilename);
+  std::size_t Update();
+
+  // binary sidecar with the accepted frames, see cMotionCache
+  bool LoadFromCache(const string& sFilename, const string& sCacheFile);
+  bool WriteCache(const string& sCacheFile);
+
+  // accepted frames, read from the cache if one is open
+  std::size_t Size();
+  // counts of accepted and rejected frames so far, also while following a
+  // recording; empty for a motion read from the cache
+  const cValidationStats& Statistics();
+
+  // the frames are ordered by time; frame 0 is the calibrated pose, it has
+  // time 0 and is left out of the searches, which take O(log n)
+  std::int64_t GetTime(std::size_t nFrame);
+  // first frame at or after nTime, Size() if there is none
+  std::size_t SeekTime(std::int64_t nTime);
+  // frame with the time closest to nTime, Size() if there is no recorded frame
+  std::size_t NearestFrame(std::int64_t nTime);
+  // the frames [nFirst, nEnd) have a time in [nFrom, nTo)
+  void GetTimeRange(std::int64_t nFrom, std::int64_t nTo, std::size_t& nFirst, std::size_t& nEnd);
+
+  // per joint the positions of all frames, already placed in the wall scene
+  std::vector<std::vector<cVector3<double>>> GetJoints();
+  // the same for the frames [nFirst, nEnd) only
+  std::vector<std::vector<cVector3<double>>> GetJoints(std::size_t nFirst, std::size_t nEnd);
+  // writes the scene positions of the frames [nFirst, nEnd) of one joint straight
+  // to pOut[0, nEnd - nFirst), any point type constructible from x, y, z works
+  template<class tPoint>
+  void ExportJoint(eJointType eType, std::size_t nFirst, std::size_t nEnd, tPoint* pOut);
+  // speed, acceleration and jerk of every joint (eJointType order) over the
+  // frames [nFirst, nEnd), see cKinematics; the joints are spread over the
+  // parser threads. The calibrated pose takes the values of frame 1.
+  void GetKinematics(std::size_t nFirst, std::size_t nEnd, std::vector<sJointKinematics>& vecJoints);
+  // quantized copy of all accepted frames for keeping many motions in memory
+  void GetCompactMotion(cCompactMotion& oMotion);
+  // runs all frames through the detector after a Reset; the calibrated pose
+  // touches no hold, so the contact table is indexed like the frames
+  void DetectContacts(cContactDetector& oDetector);
 
 private:
   cVector3<float> m_oResult;
 
   std::shared_ptr<cHierarchicMotion> m_pHierarchicMotion;
+  cSkeletonFrames m_oFrames;
+  cSkeletonCSVParser m_oParser;
+  cMotionCache m_oCache;
+  unsigned m_nThreads;
+  unsigned m_nCalibrationFrames;
+  std::shared_ptr<cFrameFilter> m_pFilter;
+  unsigned m_nMaxGapFrames;
+  float m_fFrameRate;
+
+  std::string m_sFilename;
+  std::size_t m_nOffset;
 
-  void GetJointsFromRow(cCSVRow oRow, std::vector<std::shared_ptr<cJoint>>& oJoints);
+  void Reset(const string& sFilename);
+  std::size_t ReadAppendedRows(bool bCompleteRowsOnly);
+  std::size_t ReadCompressedRows();
+  void FeedFrames();
+  void GetFrame(std::size_t nFrame, float* pPositions);
+  std::size_t Bound(std::int64_t nTime, bool bUpper);
+  // columns of a joint from nFrame on, returns how many frames follow contiguously
+  std::size_t JointColumns(eJointType eType, std::size_t nFrame,
+                           const float*& pX, const float*& pY, const float*& pZ);
 };
 
 
+template<class tPoint>
+void cKinectCSV::ExportJoint(eJointType eType, std::size_t nFirst, std::size_t nEnd, tPoint* pOut)
+{
+  const float* pX;
+  const float* pY;
+  const float* pZ;
+  while (nFirst < nEnd)
+  {
+      std::size_t nCount = JointColumns(eType, nFirst, pX, pY, pZ);
+      if (nCount == 0)
+      {
+          break;
+      }
+      nCount = (nCount < nEnd - nFirst) ? nCount : nEnd - nFirst;
+      for (std::size_t i=0; i<nCount; ++i)
+      {
+          // camera to wall scene
+          *pOut++ = tPoint((-pX[i])+0.05, (pY[i]) +0.3, (-pZ[i]) +0.1);
+      }
+      nFirst += nCount;
+  }
+}
+
+
 
 #endif // CKINECTCSV_H
@@ -0,0 +1,222 @@
+#include "kinematics.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+cKinematics::cKinematics() :
+    m_nFrames(0)
+{
+}
+
+
+void cKinematics::SetTimes(const std::int64_t* pTime, std::size_t nFrames, double fFrameStep, float fFrameRate)
+{
+    m_nFrames = nFrames;
+    if (nFrames < 2)
+    {
+        return;
+    }
+
+    // timestamps are whole units, a frame is at least one of them
+    fFrameStep = std::max(fFrameStep, 1.0);
+    std::vector<double> vecSeconds(nFrames - 1);
+    m_vecInverseStep.resize(nFrames - 1);
+    for (std::size_t j=0; j+1<nFrames; ++j)
+    {
+        double fStep = std::max(static_cast<double>(pTime[j + 1] - pTime[j]), 0.5 * fFrameStep);
+        vecSeconds[j] = fStep / (fFrameStep * fFrameRate);
+        m_vecInverseStep[j] = static_cast<float>(1.0 / vecSeconds[j]);
+    }
+
+    m_vecWeightBefore.assign(nFrames, 0.0f);
+    m_vecWeightAfter.assign(nFrames, 0.0f);
+    m_vecInverseSpan.assign(nFrames, 0.0f);
+    for (std::size_t i=1; i+1<nFrames; ++i)
+    {
+        double fBefore = vecSeconds[i - 1];
+        double fAfter = vecSeconds[i];
+        m_vecWeightBefore[i] = static_cast<float>(fAfter / (fBefore + fAfter));
+        m_vecWeightAfter[i] = static_cast<float>(fBefore / (fBefore + fAfter));
+        m_vecInverseSpan[i] = static_cast<float>(2.0 / (fBefore + fAfter));
+    }
+}
+
+
+std::size_t cKinematics::Size() const
+{
+    return m_nFrames;
+}
+
+
+void cKinematics::Compute(const float* pX, const float* pY, const float* pZ,
+                          float* pSpeed, float* pAcceleration, float* pJerk) const
+{
+    std::size_t n = m_nFrames;
+    const float* aAxes[3] = {pX, pY, pZ};
+    float aFrame[3];
+
+    // four frames at a time where all neighbours they need are inside the
+    // recording, the others one by one
+    std::size_t i = 0;
+    for (; i<n && i<2; ++i)
+    {
+        ComputeFrame(aAxes, i, aFrame);
+        Store(aFrame, i, pSpeed, pAcceleration, pJerk);
+    }
+#ifdef KINEMATICS_SSE2
+    for (; n >= 4 && i + 4 <= n - 2; i += 4)
+    {
+        ComputeFour(aAxes, i, pSpeed, pAcceleration, pJerk);
+    }
+#endif
+    for (; i<n; ++i)
+    {
+        ComputeFrame(aAxes, i, aFrame);
+        Store(aFrame, i, pSpeed, pAcceleration, pJerk);
+    }
+}
+
+
+void cKinematics::Store(const float* pFrame, std::size_t i, float* pSpeed, float* pAcceleration, float* pJerk)
+{
+    if (pSpeed)
+    {
+        pSpeed[i] = pFrame[0];
+    }
+    if (pAcceleration)
+    {
+        pAcceleration[i] = pFrame[1];
+    }
+    if (pJerk)
+    {
+        pJerk[i] = pFrame[2];
+    }
+}
+
+
+float cKinematics::Step(const float* pAxis, std::size_t j) const
+{
+    return (pAxis[j + 1] - pAxis[j]) * m_vecInverseStep[j];
+}
+
+
+float cKinematics::Acceleration(const float* pAxis, std::size_t i) const
+{
+    // the end frames take the acceleration of their neighbour
+    std::size_t n = m_nFrames;
+    i = (i == 0) ? 1 : (i == n - 1) ? n - 2 : i;
+    return (Step(pAxis, i) - Step(pAxis, i - 1)) * m_vecInverseSpan[i];
+}
+
+
+void cKinematics::ComputeFrame(const float* const* pAxes, std::size_t i, float* pFrame) const
+{
+    std::size_t n = m_nFrames;
+    pFrame[0] = pFrame[1] = pFrame[2] = 0.0f;
+    if (n < 2)
+    {
+        return;
+    }
+
+    // only one step at the ends, and no second one to differentiate below three frames
+    std::size_t nInner = (i == 0) ? 1 : (i == n - 1) ? n - 2 : i;
+    for (int nAxis=0; nAxis<3; ++nAxis)
+    {
+        const float* pAxis = pAxes[nAxis];
+        float fSpeed = (i == 0) ? Step(pAxis, 0)
+                     : (i == n - 1) ? Step(pAxis, n - 2)
+                     : m_vecWeightBefore[i] * Step(pAxis, i - 1) + m_vecWeightAfter[i] * Step(pAxis, i);
+        pFrame[0] += fSpeed * fSpeed;
+        if (n < 3)
+        {
+            continue;
+        }
+
+        float fAcceleration = Acceleration(pAxis, i);
+        float fBefore = (Acceleration(pAxis, nInner) - Acceleration(pAxis, nInner - 1)) * m_vecInverseStep[nInner - 1];
+        float fAfter = (Acceleration(pAxis, nInner + 1) - Acceleration(pAxis, nInner)) * m_vecInverseStep[nInner];
+        float fJerk = m_vecWeightBefore[nInner] * fBefore + m_vecWeightAfter[nInner] * fAfter;
+        pFrame[1] += fAcceleration * fAcceleration;
+        pFrame[2] += fJerk * fJerk;
+    }
+
+    for (int k=0; k<3; ++k)
+    {
+        pFrame[k] = std::sqrt(pFrame[k]);
+    }
+}
+
+
+#ifdef KINEMATICS_SSE2
+void cKinematics::ComputeFour(const float* const* pAxes, std::size_t i,
+                              float* pSpeed, float* pAcceleration, float* pJerk) const
+{
+    // frames i .. i + 3, all with two neighbours that have two neighbours:
+    // steps i - 2 .. i + 4 and accelerations i - 1 .. i + 4 are regular
+    const float* pInverseStep = m_vecInverseStep.data() + i;
+    const float* pInverseSpan = m_vecInverseSpan.data() + i;
+    __m128 vInverseStepM2 = _mm_loadu_ps(pInverseStep - 2);
+    __m128 vInverseStepM1 = _mm_loadu_ps(pInverseStep - 1);
+    __m128 vInverseStep0 = _mm_loadu_ps(pInverseStep);
+    __m128 vInverseStep1 = _mm_loadu_ps(pInverseStep + 1);
+    __m128 vInverseSpanM1 = _mm_loadu_ps(pInverseSpan - 1);
+    __m128 vInverseSpan0 = _mm_loadu_ps(pInverseSpan);
+    __m128 vInverseSpan1 = _mm_loadu_ps(pInverseSpan + 1);
+    __m128 vBefore = _mm_loadu_ps(m_vecWeightBefore.data() + i);
+    __m128 vAfter = _mm_loadu_ps(m_vecWeightAfter.data() + i);
+
+    __m128 vSpeed = _mm_setzero_ps();
+    __m128 vAcceleration = _mm_setzero_ps();
+    __m128 vJerk = _mm_setzero_ps();
+    for (int nAxis=0; nAxis<3; ++nAxis)
+    {
+        const float* pAxis = pAxes[nAxis] + i;
+        __m128 vXM2 = _mm_loadu_ps(pAxis - 2);
+        __m128 vXM1 = _mm_loadu_ps(pAxis - 1);
+        __m128 vX0 = _mm_loadu_ps(pAxis);
+        __m128 vX1 = _mm_loadu_ps(pAxis + 1);
+        __m128 vX2 = _mm_loadu_ps(pAxis + 2);
+
+        // steps j = i - 2 .. i + 1 relative to every frame
+        __m128 vStepM2 = _mm_mul_ps(_mm_sub_ps(vXM1, vXM2), vInverseStepM2);
+        __m128 vStepM1 = _mm_mul_ps(_mm_sub_ps(vX0, vXM1), vInverseStepM1);
+        __m128 vStep0 = _mm_mul_ps(_mm_sub_ps(vX1, vX0), vInverseStep0);
+        __m128 vStep1 = _mm_mul_ps(_mm_sub_ps(vX2, vX1), vInverseStep1);
+
+        __m128 vVelocity = _mm_add_ps(_mm_mul_ps(vBefore, vStepM1), _mm_mul_ps(vAfter, vStep0));
+        __m128 vAccelerationM1 = _mm_mul_ps(_mm_sub_ps(vStepM1, vStepM2), vInverseSpanM1);
+        __m128 vAcceleration0 = _mm_mul_ps(_mm_sub_ps(vStep0, vStepM1), vInverseSpan0);
+        __m128 vAcceleration1 = _mm_mul_ps(_mm_sub_ps(vStep1, vStep0), vInverseSpan1);
+        __m128 vJerkBefore = _mm_mul_ps(_mm_sub_ps(vAcceleration0, vAccelerationM1), vInverseStepM1);
+        __m128 vJerkAfter = _mm_mul_ps(_mm_sub_ps(vAcceleration1, vAcceleration0), vInverseStep0);
+        __m128 vJerkAxis = _mm_add_ps(_mm_mul_ps(vBefore, vJerkBefore), _mm_mul_ps(vAfter, vJerkAfter));
+
+        vSpeed = _mm_add_ps(vSpeed, _mm_mul_ps(vVelocity, vVelocity));
+        vAcceleration = _mm_add_ps(vAcceleration, _mm_mul_ps(vAcceleration0, vAcceleration0));
+        vJerk = _mm_add_ps(vJerk, _mm_mul_ps(vJerkAxis, vJerkAxis));
+    }
+
+    if (pSpeed)
+    {
+        _mm_storeu_ps(pSpeed + i, _mm_sqrt_ps(vSpeed));
+    }
+    if (pAcceleration)
+    {
+        _mm_storeu_ps(pAcceleration + i, _mm_sqrt_ps(vAcceleration));
+    }
+    if (pJerk)
+    {
+        _mm_storeu_ps(pJerk + i, _mm_sqrt_ps(vJerk));
+    }
+}
+#endif
+
+
+void cKinematics::Compute(const float* pX, const float* pY, const float* pZ, sJointKinematics& oJoint) const
+{
+    oJoint.vecSpeed.resize(m_nFrames);
+    oJoint.vecAcceleration.resize(m_nFrames);
+    oJoint.vecJerk.resize(m_nFrames);
+    Compute(pX, pY, pZ, oJoint.vecSpeed.data(), oJoint.vecAcceleration.data(), oJoint.vecJerk.data());
+}
@@ -0,0 +1,71 @@
+#ifndef CKINEMATICS_H
+#define CKINEMATICS_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#define KINEMATICS_SSE2
+#endif
+
+
+// magnitudes per frame of one joint, in m/s, m/s^2 and m/s^3
+struct sJointKinematics
+{
+  std::vector<float> vecSpeed;
+  std::vector<float> vecAcceleration;
+  std::vector<float> vecJerk;
+};
+
+
+/* Speed, acceleration and jerk along joint trajectories. The derivatives
+ * are central finite differences weighted by the actual time steps, so
+ * frames that came late or were dropped do not show up as jumps; the first
+ * and last frame take the values of their neighbour. As everywhere else the
+ * time unit of a recording is unknown, the step of the sensor clock is passed
+ * in as one frame. Steps shorter than half of that (repeated timestamps)
+ * count as half a frame. The time terms are prepared once by
+ * SetTimes and shared by all joints; Compute reads the columns once and
+ * takes four frames per SSE2 instruction, nothing in between goes to memory. */
+class cKinematics
+{
+public:
+  cKinematics();
+
+  // fFrameStep is one sensor frame in the time unit of pTime, see cHierarchicMotion::FrameStep
+  void SetTimes(const std::int64_t* pTime, std::size_t nFrames, double fFrameStep, float fFrameRate = 30.0f);
+  std::size_t Size() const;
+
+  // the columns pX/pY/pZ hold Size() positions of one joint; outputs that
+  // are not needed may be NULL
+  void Compute(const float* pX, const float* pY, const float* pZ,
+               float* pSpeed, float* pAcceleration, float* pJerk) const;
+  void Compute(const float* pX, const float* pY, const float* pZ, sJointKinematics& oJoint) const;
+
+private:
+  std::size_t m_nFrames;
+  // per step between frame i and i + 1: 1 / step
+  std::vector<float> m_vecInverseStep;
+  // per frame i with two neighbours: weights of the steps before and after
+  // it for the first derivative, and 2 / (both steps) for the second
+  std::vector<float> m_vecWeightBefore;
+  std::vector<float> m_vecWeightAfter;
+  std::vector<float> m_vecInverseSpan;
+
+  // velocity over the step from frame j to j + 1, and acceleration at frame i
+  float Step(const float* pAxis, std::size_t j) const;
+  float Acceleration(const float* pAxis, std::size_t i) const;
+  // speed, acceleration and jerk of frame i, any frame of the recording
+  void ComputeFrame(const float* const* pAxes, std::size_t i, float* pFrame) const;
+  static void Store(const float* pFrame, std::size_t i, float* pSpeed, float* pAcceleration, float* pJerk);
+
+#ifdef KINEMATICS_SSE2
+  // the frames i .. i + 3, which need 2 <= i and i + 3 < Size() - 2
+  void ComputeFour(const float* const* pAxes, std::size_t i,
+                   float* pSpeed, float* pAcceleration, float* pJerk) const;
+#endif
+};
+
+#endif // CKINEMATICS_H
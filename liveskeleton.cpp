@@ -0,0 +1,279 @@
+#include "liveskeleton.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <chrono>
+#include <cstring>
+
+
+const std::uint32_t cLiveSkeleton::nPacketMagic;
+
+
+cLiveSkeleton::cLiveSkeleton(std::size_t nRingFrames) :
+    m_oRing(nRingFrames),
+    m_nCalibrationFrames(50),
+    m_nMaxGapFrames(0),
+    m_fFrameRate(30.0f),
+    m_nSocket(-1),
+    m_nPort(0),
+    m_bRunning(false),
+    m_nReceived(0),
+    m_nMalformed(0),
+    m_oLatencyMedian(0.5),
+    m_oLatencyTail(0.99),
+    m_fMaxLatency(0.0)
+{
+    Reset();
+}
+
+
+cLiveSkeleton::~cLiveSkeleton()
+{
+    Stop();
+}
+
+
+void cLiveSkeleton::SetCalibrationFrames(unsigned nFrames)
+{
+    m_nCalibrationFrames = nFrames;
+    m_pMotion->SetCalibrationFrames(nFrames);
+}
+
+
+void cLiveSkeleton::SetFilter(std::shared_ptr<cFrameFilter> pFilter, unsigned nMaxGapFrames, float fFrameRate)
+{
+    m_pFilter = pFilter;
+    m_nMaxGapFrames = nMaxGapFrames;
+    m_fFrameRate = fFrameRate;
+    m_pMotion->SetFilter(m_pFilter, m_nMaxGapFrames, m_fFrameRate);
+}
+
+
+bool cLiveSkeleton::Start(unsigned short nPort)
+{
+    Stop();
+
+    m_nSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_nSocket < 0)
+    {
+        return false;
+    }
+
+    sockaddr_in oAddress;
+    memset(&oAddress, 0, sizeof(oAddress));
+    oAddress.sin_family = AF_INET;
+    oAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    oAddress.sin_port = htons(nPort);
+
+    // the timeout lets the receiver notice Stop while no sensor is sending
+    timeval oTimeout = {0, 100000};
+    socklen_t nLength = sizeof(oAddress);
+    if (bind(m_nSocket, reinterpret_cast<sockaddr*>(&oAddress), sizeof(oAddress)) != 0
+        || setsockopt(m_nSocket, SOL_SOCKET, SO_RCVTIMEO, &oTimeout, sizeof(oTimeout)) != 0
+        || getsockname(m_nSocket, reinterpret_cast<sockaddr*>(&oAddress), &nLength) != 0)
+    {
+        close(m_nSocket);
+        m_nSocket = -1;
+        return false;
+    }
+    m_nPort = ntohs(oAddress.sin_port);
+
+    m_oParser = cSkeletonCSVParser();
+    m_bRunning = true;
+    m_oReceiver = std::thread(&cLiveSkeleton::Receive, this);
+    return true;
+}
+
+
+void cLiveSkeleton::Stop()
+{
+    m_bRunning = false;
+    if (m_oReceiver.joinable())
+    {
+        m_oReceiver.join();
+    }
+    if (m_nSocket >= 0)
+    {
+        close(m_nSocket);
+        m_nSocket = -1;
+    }
+}
+
+
+bool cLiveSkeleton::Running() const
+{
+    return m_bRunning;
+}
+
+
+unsigned short cLiveSkeleton::Port() const
+{
+    return m_nPort;
+}
+
+
+void cLiveSkeleton::Receive()
+{
+    // a datagram holds at most 64 KB, enough for a header and a few hundred rows
+    std::vector<char> vecBuffer(65536);
+    while (m_bRunning)
+    {
+        ssize_t nBytes = recv(m_nSocket, vecBuffer.data(), vecBuffer.size(), 0);
+        if (nBytes <= 0)
+        {
+            continue;
+        }
+        std::int64_t nReceipt = cFrameRing::Now();
+
+        sPacket oPacket;
+        if (static_cast<std::size_t>(nBytes) == sizeof(sPacket))
+        {
+            memcpy(&oPacket, vecBuffer.data(), sizeof(sPacket));
+            if (oPacket.nMagic == nPacketMagic)
+            {
+                Queue(oPacket.nTime, oPacket.nSent ? oPacket.nSent : nReceipt, oPacket.aPositions);
+                continue;
+            }
+        }
+
+        // rows of a recording, a header row only updates the schema; a
+        // "header" that names no column is junk on the port
+        bool bAccepted;
+        const char* pEnd = vecBuffer.data() + nBytes;
+        const char* pBegin = m_oParser.ReadHeader(vecBuffer.data(), pEnd, bAccepted);
+        m_oRows.Clear();
+        if (!bAccepted
+            || (m_oParser.Parse(pBegin, pEnd, m_oRows) == 0 && pBegin < pEnd
+                && (isdigit(static_cast<unsigned char>(*pBegin)) || *pBegin == '-')))
+        {
+            ++m_nMalformed;
+            continue;
+        }
+
+        float aPositions[cSkeletonFrames::nColumns];
+        for (std::size_t nRow=0; nRow<m_oRows.Size(); ++nRow)
+        {
+            for (std::size_t nColumn=0; nColumn<cSkeletonFrames::nColumns; ++nColumn)
+            {
+                aPositions[nColumn] = m_oRows.Column(nColumn)[nRow];
+            }
+            Queue(m_oRows.Time(nRow), nReceipt, aPositions);
+        }
+    }
+}
+
+
+void cLiveSkeleton::Queue(std::int64_t nTime, std::int64_t nStamp, const float* pPositions)
+{
+    cFrameRing::sFrame oFrame;
+    oFrame.nTime = nTime;
+    oFrame.nStamp = nStamp;
+    memcpy(oFrame.aPositions, pPositions, sizeof(oFrame.aPositions));
+    m_oRing.Push(oFrame);
+    ++m_nReceived;
+}
+
+
+std::size_t cLiveSkeleton::Poll(double fWaitSeconds)
+{
+    auto oDeadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(fWaitSeconds);
+
+    std::size_t nFrames = 0;
+    cFrameRing::sFrame oFrame;
+    for (;;)
+    {
+        while (m_oRing.Pop(oFrame))
+        {
+            Feed(oFrame);
+            ++nFrames;
+        }
+        if (nFrames > 0 || std::chrono::steady_clock::now() >= oDeadline)
+        {
+            return nFrames;
+        }
+        // short enough to stay far below a frame period of the sensor
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+
+
+void cLiveSkeleton::Feed(cFrameRing::sFrame& oFrame)
+{
+    // position relative to camera, as for recordings
+    for (int i=0; i<JT_Count; ++i)
+    {
+        oFrame.aPositions[i * 3] = -oFrame.aPositions[i * 3];
+    }
+
+    if (!m_pMotion->Initialized())
+    {
+        m_pMotion->Init(oFrame.nTime, oFrame.aPositions);
+    }
+    else
+    {
+        m_pMotion->ExtendMotion(oFrame.nTime, oFrame.aPositions);
+    }
+
+    double fLatency = (cFrameRing::Now() - oFrame.nStamp) * 1e-9;
+    m_oLatencyMedian.Add(fLatency);
+    m_oLatencyTail.Add(fLatency);
+    m_fMaxLatency = (fLatency > m_fMaxLatency) ? fLatency : m_fMaxLatency;
+}
+
+
+void cLiveSkeleton::Reset()
+{
+    m_pMotion = std::make_shared<cHierarchicMotion>();
+    m_pMotion->SetCalibrationFrames(m_nCalibrationFrames);
+    m_pMotion->SetFilter(m_pFilter, m_nMaxGapFrames, m_fFrameRate);
+    m_oLatencyMedian.Reset();
+    m_oLatencyTail.Reset();
+    m_fMaxLatency = 0.0;
+}
+
+
+const std::shared_ptr<cHierarchicMotion>& cLiveSkeleton::Motion() const
+{
+    return m_pMotion;
+}
+
+
+std::size_t cLiveSkeleton::Received() const
+{
+    return m_nReceived;
+}
+
+
+std::size_t cLiveSkeleton::Dropped() const
+{
+    return m_oRing.Dropped();
+}
+
+
+std::size_t cLiveSkeleton::Malformed() const
+{
+    return m_nMalformed;
+}
+
+
+double cLiveSkeleton::LatencyMedian() const
+{
+    return m_oLatencyMedian.Value();
+}
+
+
+double cLiveSkeleton::LatencyTail() const
+{
+    return m_oLatencyTail.Value();
+}
+
+
+double cLiveSkeleton::LatencyMax() const
+{
+    return m_fMaxLatency;
+}
@@ -0,0 +1,101 @@
+#ifndef CLIVESKELETON_H
+#define CLIVESKELETON_H
+
+#include "framering.h"
+#include "hierarchicmotion.h"
+#include "skeletonparser.h"
+#include "p2quantile.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+
+
+/* Receives skeleton frames from a live sensor over UDP on localhost.
+ * A datagram is either one sPacket or rows in the layout of the recordings
+ * (a header row may come first, it stays in effect for later rows). The
+ * receiver thread only decodes and queues the frames in a cFrameRing; Poll,
+ * called on the thread that owns the motion, moves them into a
+ * cHierarchicMotion, so the motion needs no locking. The time between a
+ * frame leaving the sensor and being part of the motion is measured for
+ * every frame. */
+class cLiveSkeleton
+{
+public:
+  static const std::uint32_t nPacketMagic = 0x314c4b53; // "SKL1"
+
+  // binary frame, native byte order; positions as recorded (x not flipped)
+  struct sPacket
+  {
+    std::uint32_t nMagic;
+    std::uint32_t nReserved;
+    std::int64_t nTime;
+    // cFrameRing::Now of the sender, 0 measures from the receipt instead
+    std::int64_t nSent;
+    float aPositions[cSkeletonFrames::nColumns];
+  };
+
+  cLiveSkeleton(std::size_t nRingFrames = 256);
+  ~cLiveSkeleton();
+
+  // see cHierarchicMotion, only has an effect before the first frame
+  void SetCalibrationFrames(unsigned nFrames);
+  void SetFilter(std::shared_ptr<cFrameFilter> pFilter, unsigned nMaxGapFrames, float fFrameRate = 30.0f);
+
+  // binds 127.0.0.1:nPort (0 picks a free port) and starts receiving,
+  // false if the socket cannot be opened
+  bool Start(unsigned short nPort);
+  void Stop();
+  bool Running() const;
+  unsigned short Port() const;
+
+  // moves all queued frames into the motion and returns how many there were;
+  // waits up to fWaitSeconds for the first one
+  std::size_t Poll(double fWaitSeconds = 0.0);
+  // drops the motion and starts a new calibration
+  void Reset();
+  const std::shared_ptr<cHierarchicMotion>& Motion() const;
+
+  // frames decoded by the receiver, dropped because the ring was full, and
+  // datagrams that could not be read
+  std::size_t Received() const;
+  std::size_t Dropped() const;
+  std::size_t Malformed() const;
+
+  // seconds from sending to being in the motion over the frames polled so
+  // far: median, 99th percentile and maximum
+  double LatencyMedian() const;
+  double LatencyTail() const;
+  double LatencyMax() const;
+
+private:
+  cFrameRing m_oRing;
+  std::shared_ptr<cHierarchicMotion> m_pMotion;
+  unsigned m_nCalibrationFrames;
+  std::shared_ptr<cFrameFilter> m_pFilter;
+  unsigned m_nMaxGapFrames;
+  float m_fFrameRate;
+
+  // receiver thread
+  int m_nSocket;
+  unsigned short m_nPort;
+  std::thread m_oReceiver;
+  std::atomic<bool> m_bRunning;
+  std::atomic<std::size_t> m_nReceived;
+  std::atomic<std::size_t> m_nMalformed;
+  cSkeletonCSVParser m_oParser;
+  cSkeletonFrames m_oRows;
+
+  // consumer thread
+  cP2Quantile m_oLatencyMedian;
+  cP2Quantile m_oLatencyTail;
+  double m_fMaxLatency;
+
+  void Receive();
+  void Queue(std::int64_t nTime, std::int64_t nStamp, const float* pPositions);
+  void Feed(cFrameRing::sFrame& oFrame);
+};
+
+#endif // CLIVESKELETON_H
@@ -0,0 +1,148 @@
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+cMappedFile::cMappedFile() :
+    m_pData(NULL),
+    m_nSize(0)
+{
+}
+
+
+cMappedFile::cMappedFile(const std::string& sFilename) :
+    m_pData(NULL),
+    m_nSize(0)
+{
+    Open(sFilename);
+}
+
+
+cMappedFile::~cMappedFile()
+{
+    Close();
+}
+
+
+#ifdef _WIN32
+
+bool cMappedFile::Open(const std::string& sFilename)
+{
+    Close();
+
+    std::ifstream oFile(sFilename, std::ios::binary | std::ios::ate);
+    if (!oFile)
+    {
+        return false;
+    }
+
+    std::streamoff nSize = oFile.tellg();
+    oFile.seekg(0, std::ios::beg);
+    m_vecBuffer.resize(static_cast<std::size_t>(nSize));
+    if (nSize > 0 && !oFile.read(m_vecBuffer.data(), nSize))
+    {
+        m_vecBuffer.clear();
+        return false;
+    }
+
+    m_nSize = m_vecBuffer.size();
+    m_pData = m_nSize ? m_vecBuffer.data() : "";
+    return true;
+}
+
+
+void cMappedFile::Close()
+{
+    std::vector<char>().swap(m_vecBuffer);
+    m_pData = NULL;
+    m_nSize = 0;
+}
+
+#else
+
+bool cMappedFile::Open(const std::string& sFilename)
+{
+    Close();
+
+    int nFd = open(sFilename.c_str(), O_RDONLY);
+    if (nFd < 0)
+    {
+        return false;
+    }
+
+    struct stat oStat;
+    if (fstat(nFd, &oStat) != 0)
+    {
+        close(nFd);
+        return false;
+    }
+
+    m_nSize = static_cast<std::size_t>(oStat.st_size);
+
+    // an empty file can not be mapped, but is still a valid (empty) input
+    if (m_nSize == 0)
+    {
+        close(nFd);
+        m_pData = "";
+        return true;
+    }
+
+    void* pMap = mmap(NULL, m_nSize, PROT_READ, MAP_PRIVATE, nFd, 0);
+    close(nFd);
+
+    if (pMap == MAP_FAILED)
+    {
+        m_nSize = 0;
+        return false;
+    }
+
+    // rows are consumed front to back, let the kernel read ahead
+    madvise(pMap, m_nSize, MADV_SEQUENTIAL);
+
+    m_pData = static_cast<const char*>(pMap);
+    return true;
+}
+
+
+void cMappedFile::Close()
+{
+    if (m_pData && m_nSize > 0)
+    {
+        munmap(const_cast<char*>(m_pData), m_nSize);
+    }
+    m_pData = NULL;
+    m_nSize = 0;
+}
+
+#endif
+
+
+bool cMappedFile::IsOpen() const
+{
+    return m_pData != NULL;
+}
+
+
+const char* cMappedFile::Begin() const
+{
+    return m_pData;
+}
+
+
+const char* cMappedFile::End() const
+{
+    return m_pData + m_nSize;
+}
+
+
+std::size_t cMappedFile::Size() const
+{
+    return m_nSize;
+}
@@ -0,0 +1,39 @@
+#ifndef CMAPPEDFILE_H
+#define CMAPPEDFILE_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+
+/* Read-only memory mapping of a whole file. The mapping lives as long as the
+ * object, so views handed out into [Begin(), End()) must not outlive it.
+ * Without POSIX mmap (_WIN32) the file is read into memory with an ifstream
+ * instead, behind the same interface. */
+class cMappedFile
+{
+public:
+  cMappedFile();
+  explicit cMappedFile(const std::string& sFilename);
+  ~cMappedFile();
+
+  cMappedFile(const cMappedFile&) = delete;
+  cMappedFile& operator=(const cMappedFile&) = delete;
+
+  bool Open(const std::string& sFilename);
+  void Close();
+
+  bool IsOpen() const;
+  const char* Begin() const;
+  const char* End() const;
+  std::size_t Size() const;
+
+private:
+  const char* m_pData;
+  std::size_t m_nSize;
+#ifdef _WIN32
+  std::vector<char> m_vecBuffer;
+#endif
+};
+
+#endif // CMAPPEDFILE_H
@@ -0,0 +1,179 @@
+#include "motionbatch.h"
+#include "parallel.h"
+
+#include <sys/stat.h>
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
+
+
+namespace
+{
+    std::size_t FileSize(const std::string& sFilename)
+    {
+        struct stat oStat;
+        return (stat(sFilename.c_str(), &oStat) == 0) ? static_cast<std::size_t>(oStat.st_size) : 0;
+    }
+}
+
+
+cMotionBatch::cMotionBatch(unsigned nThreads) :
+    m_nThreads(nThreads),
+    m_nCalibrationFrames(50),
+    m_oSummary({0, 0, 0, 0, 0.0, 0.0})
+{
+}
+
+
+void cMotionBatch::SetCalibrationFrames(unsigned nFrames)
+{
+    m_nCalibrationFrames = nFrames;
+}
+
+
+const cMotionBatch::sSummary& cMotionBatch::Summary() const
+{
+    return m_oSummary;
+}
+
+
+const char* cMotionBatch::StatusText(eStatus eResult)
+{
+    switch (eResult)
+    {
+    case MB_OK:             return "ok";
+    case MB_NOT_FOUND:      return "file not found";
+    case MB_CORRUPT:        return "corrupt file";
+    case MB_FAILED:         return "failed to load";
+    case MB_HANDLER_FAILED: return "handler failed";
+    }
+    return "unknown";
+}
+
+
+std::vector<cMotionBatch::sRecording> cMotionBatch::Load(const std::vector<std::string>& vecFiles,
+                                                         const tLoadedHandler& oOnLoaded)
+{
+    std::vector<sRecording> vecRecordings;
+    Run(vecFiles, vecRecordings, oOnLoaded);
+    return vecRecordings;
+}
+
+
+std::vector<cMotionBatch::sRecording> cMotionBatch::LoadCompact(const std::vector<std::string>& vecFiles,
+                                                                std::vector<cCompactMotion>& vecMotions)
+{
+    vecMotions.clear();
+    vecMotions.resize(vecFiles.size());
+
+    // the recordings are not moved while the workers run, their position is the index
+    std::vector<sRecording> vecRecordings;
+    Run(vecFiles, vecRecordings, [&](const sRecording& oRecording, cKinectCSV& oKinect)
+    {
+        oKinect.GetCompactMotion(vecMotions[&oRecording - vecRecordings.data()]);
+    });
+
+    for (std::size_t i=0; i<vecRecordings.size(); ++i)
+    {
+        if (vecRecordings[i].eResult != MB_OK)
+        {
+            vecMotions[i].Clear();
+        }
+    }
+    return vecRecordings;
+}
+
+
+void cMotionBatch::Run(const std::vector<std::string>& vecFiles, std::vector<sRecording>& vecRecordings,
+                       const tLoadedHandler& oOnLoaded)
+{
+    auto oStart = std::chrono::steady_clock::now();
+
+    vecRecordings.resize(vecFiles.size());
+    for (std::size_t i=0; i<vecFiles.size(); ++i)
+    {
+        vecRecordings[i] = {vecFiles[i], MB_OK, 0, 0, 0.0};
+    }
+
+    std::size_t nWorkers = m_nThreads ? m_nThreads : HardwareThreads();
+    nWorkers = (nWorkers < vecFiles.size()) ? nWorkers : vecFiles.size();
+
+    // the files are handed out one at a time, a recording is parsed on one thread only
+    std::atomic<std::size_t> nNext(0);
+    auto oWorker = [&]()
+    {
+        cKinectCSV oKinect;
+        oKinect.SetThreadCount(1);
+        oKinect.SetCalibrationFrames(m_nCalibrationFrames);
+        for (std::size_t i=nNext++; i<vecRecordings.size(); i=nNext++)
+        {
+            LoadOne(oKinect, vecRecordings[i], oOnLoaded);
+        }
+    };
+
+    std::vector<std::thread> vecThreads;
+    for (std::size_t nWorker=1; nWorker<nWorkers; ++nWorker)
+    {
+        vecThreads.push_back(std::thread(oWorker));
+    }
+    if (nWorkers > 0)
+    {
+        oWorker();
+    }
+    for (auto& oThread : vecThreads)
+    {
+        oThread.join();
+    }
+
+    m_oSummary = {vecRecordings.size(), 0, 0, 0, 0.0, 0.0};
+    for (const sRecording& oRecording : vecRecordings)
+    {
+        m_oSummary.nFailed += (oRecording.eResult != MB_OK) ? 1 : 0;
+        m_oSummary.nBytes += oRecording.nBytes;
+        m_oSummary.nFrames += oRecording.nFrames;
+        m_oSummary.fBusySeconds += oRecording.fSeconds;
+    }
+    m_oSummary.fSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - oStart).count();
+}
+
+
+void cMotionBatch::LoadOne(cKinectCSV& oKinect, sRecording& oRecording, const tLoadedHandler& oOnLoaded)
+{
+    auto oStart = std::chrono::steady_clock::now();
+    oRecording.nBytes = FileSize(oRecording.sFilename);
+
+    try
+    {
+        oKinect.LoadFromFile(oRecording.sFilename);
+        oRecording.nFrames = oKinect.Size();
+    }
+    catch (const fileNotFound&)
+    {
+        oRecording.eResult = MB_NOT_FOUND;
+    }
+    catch (const corruptFile&)
+    {
+        oRecording.eResult = MB_CORRUPT;
+    }
+    catch (const std::exception&)
+    {
+        oRecording.eResult = MB_FAILED;
+    }
+
+    oRecording.fSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - oStart).count();
+
+    // the handler runs on a worker thread, nothing it throws may leave it
+    if (oRecording.eResult == MB_OK && oOnLoaded)
+    {
+        try
+        {
+            oOnLoaded(oRecording, oKinect);
+        }
+        catch (...)
+        {
+            oRecording.eResult = MB_HANDLER_FAILED;
+        }
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef CMOTIONBATCH_H
+#define CMOTIONBATCH_H
+
+#include "kinectcsv.h"
+#include "compactmotion.h"
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <functional>
+
+
+/* Loads the recordings of a whole session on a fixed number of worker
+ * threads. Every worker owns one cKinectCSV and takes the next file as soon
+ * as it is done with the last one, so long and short recordings balance out.
+ * A worker only holds the motion of the recording it is working on: the
+ * handler gets it right after loading and the next file replaces it, so
+ * memory grows with the thread count, not with the number of files. */
+class cMotionBatch
+{
+public:
+  enum eStatus
+  {
+    MB_OK = 0,
+    MB_NOT_FOUND,
+    MB_CORRUPT,
+    // any other error while loading, e.g. out of memory
+    MB_FAILED,
+    // the recording was loaded, but the handler threw
+    MB_HANDLER_FAILED
+  };
+
+  struct sRecording
+  {
+    std::string sFilename;
+    eStatus eResult;
+    std::size_t nBytes;
+    std::size_t nFrames;
+    double fSeconds;
+  };
+
+  struct sSummary
+  {
+    std::size_t nRecordings;
+    std::size_t nFailed;
+    std::size_t nBytes;
+    std::size_t nFrames;
+    // wall time of the batch and time spent in the single recordings
+    double fSeconds;
+    double fBusySeconds;
+  };
+
+  // called on the worker threads, possibly for several recordings at once;
+  // if it throws, the recording is marked MB_HANDLER_FAILED and the batch goes on
+  typedef std::function<void(const sRecording& oRecording, cKinectCSV& oKinect)> tLoadedHandler;
+
+  // nThreads == 0 uses all cores
+  cMotionBatch(unsigned nThreads = 0);
+
+  void SetCalibrationFrames(unsigned nFrames);
+
+  // results in the order of vecFiles, failed recordings do not stop the batch
+  std::vector<sRecording> Load(const std::vector<std::string>& vecFiles,
+                               const tLoadedHandler& oOnLoaded = tLoadedHandler());
+  // loads a motion library: every recording is kept quantized, see
+  // cCompactMotion, and only the workers hold float frames, of one recording
+  // each. vecMotions[i] belongs to vecFiles[i], it stays empty if that failed
+  std::vector<sRecording> LoadCompact(const std::vector<std::string>& vecFiles,
+                                      std::vector<cCompactMotion>& vecMotions);
+  const sSummary& Summary() const;
+
+  static const char* StatusText(eStatus eResult);
+
+private:
+  unsigned m_nThreads;
+  unsigned m_nCalibrationFrames;
+  sSummary m_oSummary;
+
+  void Run(const std::vector<std::string>& vecFiles, std::vector<sRecording>& vecRecordings,
+           const tLoadedHandler& oOnLoaded);
+  void LoadOne(cKinectCSV& oKinect, sRecording& oRecording, const tLoadedHandler& oOnLoaded);
+};
+
+#endif // CMOTIONBATCH_H
@@ -0,0 +1,193 @@
+#include "motioncache.h"
+
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+
+
+namespace
+{
+    const char aMotionCacheMagic[8] = {'V', 'I', 'S', 'M', 'O', 'T', 'N', '\0'};
+    // 2: streaming calibration, calibration window in the header
+    // 3: time column
+    // 4: filter settings in the header
+    // 5: frame step in the header
+    const std::uint32_t nMotionCacheVersion = 5;
+}
+
+
+cMotionCache::cMotionCache() :
+    m_pHeader(NULL),
+    m_pTime(NULL),
+    m_pData(NULL)
+{
+}
+
+
+bool cMotionCache::GetSourceInfo(const std::string& sSourceFile, std::uint64_t& nSize, std::int64_t& nTime)
+{
+    struct stat oStat;
+    if (stat(sSourceFile.c_str(), &oStat) != 0)
+    {
+        return false;
+    }
+
+    nSize = static_cast<std::uint64_t>(oStat.st_size);
+    nTime = static_cast<std::int64_t>(oStat.st_mtime);
+    return true;
+}
+
+
+bool cMotionCache::Write(const std::string& sCacheFile, const std::string& sSourceFile,
+                         const cSkeletonFrames& oFrames, const float* pLimbLengths, double fFrameStep,
+                         unsigned nCalibrationFrames, const std::string& sFilter)
+{
+    sHeader oHeader;
+    memset(&oHeader, 0, sizeof(oHeader));
+    memcpy(oHeader.aMagic, aMotionCacheMagic, sizeof(oHeader.aMagic));
+    oHeader.nVersion = nMotionCacheVersion;
+    oHeader.nJointCount = JT_Count;
+    oHeader.nFrameCount = oFrames.Size();
+    if (!GetSourceInfo(sSourceFile, oHeader.nSourceSize, oHeader.nSourceTime))
+    {
+        return false;
+    }
+    for (int i=0; i<JT_Count; ++i)
+    {
+        oHeader.aLimbLengths[i] = pLimbLengths[i];
+    }
+    oHeader.nCalibrationFrames = nCalibrationFrames;
+    oHeader.fFrameStep = fFrameStep;
+    strncpy(oHeader.aFilter, sFilter.c_str(), sizeof(oHeader.aFilter) - 1);
+
+    // write next to the target and rename, so a reader never maps half a file
+    std::string sTempFile = sCacheFile + ".tmp";
+    {
+        std::ofstream oFile(sTempFile, std::ios::binary | std::ios::trunc);
+        if (!oFile)
+        {
+            return false;
+        }
+
+        oFile.write(reinterpret_cast<const char*>(&oHeader), sizeof(oHeader));
+        oFile.write(reinterpret_cast<const char*>(oFrames.TimeColumn()),
+                    oFrames.Size() * sizeof(std::int64_t));
+        for (std::size_t nColumn=0; nColumn<cSkeletonFrames::nColumns; ++nColumn)
+        {
+            oFile.write(reinterpret_cast<const char*>(oFrames.Column(nColumn)),
+                        oFrames.Size() * sizeof(float));
+        }
+
+        if (!oFile)
+        {
+            oFile.close();
+            remove(sTempFile.c_str());
+            return false;
+        }
+    }
+
+    return rename(sTempFile.c_str(), sCacheFile.c_str()) == 0;
+}
+
+
+bool cMotionCache::Open(const std::string& sCacheFile, const std::string& sSourceFile,
+                       unsigned nCalibrationFrames, const std::string& sFilter)
+{
+    Close();
+
+    std::uint64_t nSourceSize;
+    std::int64_t nSourceTime;
+    if (!GetSourceInfo(sSourceFile, nSourceSize, nSourceTime))
+    {
+        return false;
+    }
+
+    if (!m_oFile.Open(sCacheFile) || m_oFile.Size() < sizeof(sHeader))
+    {
+        m_oFile.Close();
+        return false;
+    }
+
+    const sHeader* pHeader = reinterpret_cast<const sHeader*>(m_oFile.Begin());
+    std::uint64_t nExpectedSize = sizeof(sHeader)
+                                + pHeader->nFrameCount * sizeof(std::int64_t)
+                                + pHeader->nFrameCount * cSkeletonFrames::nColumns * sizeof(float);
+
+    if (memcmp(pHeader->aMagic, aMotionCacheMagic, sizeof(pHeader->aMagic)) != 0
+        || pHeader->nVersion != nMotionCacheVersion
+        || pHeader->nJointCount != JT_Count
+        || m_oFile.Size() != nExpectedSize
+        || pHeader->nSourceSize != nSourceSize
+        || pHeader->nSourceTime != nSourceTime
+        || pHeader->nCalibrationFrames != nCalibrationFrames
+        || strncmp(pHeader->aFilter, sFilter.c_str(), sizeof(pHeader->aFilter) - 1) != 0)
+    {
+        m_oFile.Close();
+        return false;
+    }
+
+    m_pHeader = pHeader;
+    m_pTime = reinterpret_cast<const std::int64_t*>(m_oFile.Begin() + sizeof(sHeader));
+    m_pData = reinterpret_cast<const float*>(m_pTime + pHeader->nFrameCount);
+    return true;
+}
+
+
+void cMotionCache::Close()
+{
+    m_oFile.Close();
+    m_pHeader = NULL;
+    m_pTime = NULL;
+    m_pData = NULL;
+}
+
+
+bool cMotionCache::IsOpen() const
+{
+    return m_pHeader != NULL;
+}
+
+
+std::size_t cMotionCache::Size() const
+{
+    return m_pHeader ? static_cast<std::size_t>(m_pHeader->nFrameCount) : 0;
+}
+
+
+float cMotionCache::GetLimbLength(eJointType eType) const
+{
+    return m_pHeader->aLimbLengths[eType];
+}
+
+
+double cMotionCache::FrameStep() const
+{
+    return m_pHeader->fFrameStep;
+}
+
+
+std::int64_t cMotionCache::Time(std::size_t nFrame) const
+{
+    return m_pTime[nFrame];
+}
+
+
+const std::int64_t* cMotionCache::TimeColumn() const
+{
+    return m_pTime;
+}
+
+
+const float* cMotionCache::Column(eJointType eType, int nAxis) const
+{
+    return m_pData + (static_cast<std::size_t>(eType) * 3 + nAxis) * Size();
+}
+
+
+cVector3<float> cMotionCache::GetPosition(eJointType eType, std::size_t nFrame) const
+{
+    return cVector3<float>(Column(eType, 0)[nFrame],
+                           Column(eType, 1)[nFrame],
+                           Column(eType, 2)[nFrame]);
+}
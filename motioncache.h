@@ -0,0 +1,67 @@
+#ifndef CMOTIONCACHE_H
+#define CMOTIONCACHE_H
+
+#include "joint.h"
+#include "mappedfile.h"
+#include "skeletonframes.h"
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+
+/* Binary sidecar for a recording that has been parsed and validated once.
+ * Layout: sHeader, the nFrameCount timestamps as int64, then one column of
+ * nFrameCount floats per joint and axis (joint major, x/y/z minor). The file
+ * is memory mapped on reading, the columns are used in place. */
+class cMotionCache
+{
+public:
+  struct sHeader
+  {
+      char aMagic[8];
+      std::uint32_t nVersion;
+      std::uint32_t nJointCount;
+      std::uint64_t nFrameCount;
+      // size and modification time of the recording the cache was built from
+      std::uint64_t nSourceSize;
+      std::int64_t nSourceTime;
+      float aLimbLengths[JT_Count];
+      std::uint32_t nCalibrationFrames;
+      // cHierarchicMotion::FrameStep, the rows behind it are not cached
+      double fFrameStep;
+      // cHierarchicMotion::FilterDescription, cut to fit
+      char aFilter[64];
+  };
+
+  cMotionCache();
+
+  static bool Write(const std::string& sCacheFile, const std::string& sSourceFile,
+                    const cSkeletonFrames& oFrames, const float* pLimbLengths, double fFrameStep,
+                    unsigned nCalibrationFrames, const std::string& sFilter);
+
+  // fails if the file is missing, damaged or was built from another version
+  // of the source file or with another calibration window or filter
+  bool Open(const std::string& sCacheFile, const std::string& sSourceFile, unsigned nCalibrationFrames,
+            const std::string& sFilter);
+  void Close();
+  bool IsOpen() const;
+
+  std::size_t Size() const;
+  float GetLimbLength(eJointType eType) const;
+  double FrameStep() const;
+  std::int64_t Time(std::size_t nFrame) const;
+  const std::int64_t* TimeColumn() const;
+  const float* Column(eJointType eType, int nAxis) const;
+  cVector3<float> GetPosition(eJointType eType, std::size_t nFrame) const;
+
+private:
+  cMappedFile m_oFile;
+  const sHeader* m_pHeader;
+  const std::int64_t* m_pTime;
+  const float* m_pData;
+
+  static bool GetSourceInfo(const std::string& sSourceFile, std::uint64_t& nSize, std::int64_t& nTime);
+};
+
+#endif // CMOTIONCACHE_H
@@ -1,5 +1,7 @@
 #include "kinectcsv.h"
+#include "decimation.h"
 
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -77,6 +79,12 @@ namespace
         std::vector<std::unique_ptr<Primitive>> m_vecJoints;
         std::vector<std::vector<Point3>> m_vecJointPositions;
         std::vector<std::vector<Color>> m_vecJointColors;
+        std::vector<sJointKinematics> m_vecKinematics;
+        cContactDetector m_oContacts;
+
+        // kept between executions to follow a recording that is still growing
+        std::unique_ptr<cKinectCSV> m_pKinect;
+        std::string m_sFollowedFile;
 
     public:
 
@@ -86,6 +94,21 @@ namespace
                 DataAlgorithm::Options(control)
             {
                 add<InputLoadPath>("Input File", "The file to be read", "");
+                add<int>("Parser threads", "Threads used to parse the file, 0 uses all cores", 0);
+                add<bool>("Follow file", "Only read rows appended since the last execution", false);
+                add<bool>("Use cache", "Keep validated frames in a binary file next to the recording", false);
+                add<int>("Calibration frames", "Valid frames at the start that calibrate the limb lengths", 50);
+                add<double>("Smoothing cutoff", "Lowest cutoff frequency in Hz of the one euro filter on the joints, 0 turns smoothing off", 0.0);
+                add<double>("Smoothing beta", "Rise of the cutoff frequency in Hz per m/s of joint speed", 2.0);
+                add<int>("Fill gaps", "Gaps of up to this many rejected frames are interpolated, 0 turns gap filling off", 0);
+                add<double>("Window start", "Start of the shown window, in time units of the recording after its first frame", 0.0);
+                add<double>("Window length", "Length of the shown window in time units of the recording, 0 shows everything", 0.0);
+                add<double>("Tolerance", "Largest distance in m a dropped vertex may have from the drawn trajectory, 0 draws every frame", 0.002);
+                add<bool>("Color by speed", "Color the trajectories by the speed of the joint instead of one color per joint", true);
+                add<double>("Top speed", "Speed in m/s drawn red when coloring by speed", 2.0);
+                add<DomainBase>("Holds", "Hold candidates from Load/DepthData, in camera space");
+                add<double>("Touch radius", "Distance in m at which a hand or foot starts touching a hold", 0.08);
+                add<double>("Release radius", "Distance in m at which it lets go of the hold again", 0.12);
             }
         };
 
@@ -163,6 +186,59 @@ namespace
         }
 
 
+        void LoadRecording(const std::string& sFilename, bool bUseCache)
+        {
+            std::string sCacheFile = sFilename + ".motion";
+            if (bUseCache && m_pKinect->LoadFromCache(sFilename, sCacheFile))
+            {
+                infoLog() << "loaded " << sCacheFile << std::endl;
+                return;
+            }
+
+            m_pKinect->LoadFromFile(sFilename);
+            if (bUseCache && !m_pKinect->WriteCache(sCacheFile))
+            {
+                infoLog() << "could not write " << sCacheFile << std::endl;
+            }
+        }
+
+
+        // which hold each hand and foot touches, logged per hold for the shown frames
+        void DetectContacts(const DiscreteDomain<3>& oHolds, const Algorithm::Options& parameters,
+                            std::size_t nFirst, std::size_t nEnd)
+        {
+            std::vector<cVector3<float>> vecHolds;
+            for (std::size_t i=0; i<oHolds.numPoints(); ++i)
+            {
+                vecHolds.push_back(cVector3<float>(oHolds.points()[i][0], oHolds.points()[i][1], oHolds.points()[i][2]));
+            }
+            m_oContacts = cContactDetector(static_cast<float>(parameters.get<double>("Touch radius")),
+                                           static_cast<float>(parameters.get<double>("Release radius")));
+            m_oContacts.SetHolds(vecHolds);
+            m_pKinect->DetectContacts(m_oContacts);
+
+            for (std::size_t nHold=0; nHold<m_oContacts.Holds(); ++nHold)
+            {
+                std::size_t nTouches = 0;
+                std::size_t nFrames = 0;
+                for (const sHoldContact& oContact : m_oContacts.Timeline(nHold))
+                {
+                    std::size_t nFrom = std::max(oContact.nFirst, nFirst);
+                    std::size_t nTo = std::min(oContact.nEnd, nEnd);
+                    if (nFrom < nTo)
+                    {
+                        ++nTouches;
+                        nFrames += nTo - nFrom;
+                    }
+                }
+                if (nTouches > 0)
+                {
+                    infoLog() << "hold " << nHold << ": " << nTouches << " contacts, " << nFrames << " frames" << std::endl;
+                }
+            }
+        }
+
+
         void execute(const Algorithm::Options& parameters, const volatile bool& abortFlag) override
         {
             if (abortFlag)
@@ -180,34 +256,124 @@ namespace
                     m_vecJoints.push_back(getGraphics(sJoint).makePrimitive());
                 }
 
-                cKinectCSV oKinect;
-                oKinect.LoadFromFile(sFilename);
-                std::vector<std::vector<fantom::Point3>> vecVecPoint3 = oKinect.GetJoints();
+                bool bFollow = parameters.get<bool>("Follow file");
+                if (bFollow && m_pKinect && m_sFollowedFile == sFilename)
+                {
+                    std::size_t nRows = m_pKinect->Update();
+                    infoLog() << nRows << " new rows in " << sFilename << std::endl;
+                }
+                else
+                {
+                    m_pKinect.reset(new cKinectCSV());
+                    m_pKinect->SetThreadCount(static_cast<unsigned>(std::max(0, parameters.get<int>("Parser threads"))));
+                    m_pKinect->SetCalibrationFrames(static_cast<unsigned>(std::max(0, parameters.get<int>("Calibration frames"))));
+
+                    std::shared_ptr<cFrameFilter> pFilter;
+                    if (parameters.get<double>("Smoothing cutoff") > 0.0)
+                    {
+                        pFilter = std::make_shared<cOneEuroFilter>(static_cast<float>(parameters.get<double>("Smoothing cutoff")),
+                                                                   static_cast<float>(parameters.get<double>("Smoothing beta")));
+                    }
+                    m_pKinect->SetFilter(pFilter, static_cast<unsigned>(std::max(0, parameters.get<int>("Fill gaps"))));
+                    if (bFollow)
+                    {
+                        m_pKinect->Follow(sFilename);
+                        m_sFollowedFile = sFilename;
+                    }
+                    else
+                    {
+                        LoadRecording(sFilename, parameters.get<bool>("Use cache"));
+                        m_sFollowedFile.clear();
+                    }
+                }
+                // a motion read from the cache has not been validated in this run
+                const cValidationStats& oStats = m_pKinect->Statistics();
+                if (oStats.Calibration() > 0)
+                {
+                    infoLog() << oStats.Summary() << std::endl;
+                }
+
+                std::size_t nFirst = 0;
+                std::size_t nEnd = m_pKinect->Size();
+                double fWindowLength = parameters.get<double>("Window length");
+                if (fWindowLength > 0.0 && m_pKinect->Size() > 1)
+                {
+                    // frame 0 is the calibrated pose, the recording starts with frame 1
+                    std::int64_t nFrom = m_pKinect->GetTime(1) + static_cast<std::int64_t>(parameters.get<double>("Window start"));
+                    std::int64_t nTo = nFrom + static_cast<std::int64_t>(fWindowLength);
+                    m_pKinect->GetTimeRange(nFrom, nTo, nFirst, nEnd);
+                    infoLog() << "showing frames " << nFirst << " to " << nEnd << " of " << m_pKinect->Size() << std::endl;
+                }
 
-                m_vecJointPositions.clear();
+                // the positions go straight into the vertex buffers, which keep their capacity between executions
+                m_vecJointPositions.resize(m_vecJoints.size());
                 for (int i=0; i<m_vecJoints.size(); ++i)
                 {
-                    m_vecJointPositions.push_back(vecVecPoint3[i]);
+                    m_vecJointPositions[i].resize(nEnd - nFirst);
+                    m_pKinect->ExportJoint(static_cast<eJointType>(i), nFirst, nEnd, m_vecJointPositions[i].data());
+                }
+
+                // one color per vertex from the speed of the joint in that frame
+                bool bSpeedColors = parameters.get<bool>("Color by speed");
+                if (bSpeedColors)
+                {
+                    m_pKinect->GetKinematics(nFirst, nEnd, m_vecKinematics);
+                    float fScale = static_cast<float>(1.0 / std::max(parameters.get<double>("Top speed"), 1e-3));
+                    m_vecJointColors.resize(m_vecJoints.size());
+                    for (int i=0; i<m_vecJoints.size(); ++i)
+                    {
+                        const std::vector<float>& vecSpeed = m_vecKinematics[i].vecSpeed;
+                        m_vecJointColors[i].clear();
+                        for (float fSpeed : vecSpeed)
+                        {
+                            m_vecJointColors[i].push_back(GetHeatMapColor(fSpeed * fScale));
+                        }
+                    }
+                }
+
+                auto pHolds = parameters.get<DiscreteDomain<3>>("Holds");
+                if (pHolds)
+                {
+                    DetectContacts(*pHolds, parameters, nFirst, nEnd);
+                }
 
+                double fTolerance = parameters.get<double>("Tolerance");
+                if (fTolerance > 0.0)
+                {
+                    unsigned nThreads = static_cast<unsigned>(std::max(0, parameters.get<int>("Parser threads")));
+                    std::size_t nVertices = bSpeedColors ? DecimateLineStrips(m_vecJointPositions, m_vecJointColors, fTolerance, nThreads)
+                                                         : DecimateLineStrips(m_vecJointPositions, fTolerance, nThreads);
+                    infoLog() << nVertices << " of " << (nEnd - nFirst) * m_vecJointPositions.size() << " vertices drawn" << std::endl;
                 }
 
                 for (int i=0; i<m_vecJoints.size(); ++i)
                 {
-                    m_vecJoints[i]->add(Primitive::LINE_STRIP).setLineWidth(5.0)
-                                                              .setColor(GetHeatMapColor((1.0f / m_vecJoints.size()) * static_cast<float>(i)))
-                                                              .setVertices(m_vecJointPositions[i]);
+                    Primitive& oStrip = m_vecJoints[i]->add(Primitive::LINE_STRIP).setLineWidth(5.0);
+                    if (bSpeedColors)
+                    {
+                        oStrip.setColors(m_vecJointColors[i]);
+                    }
+                    else
+                    {
+                        oStrip.setColor(GetHeatMapColor((1.0f / m_vecJoints.size()) * static_cast<float>(i)));
+                    }
+                    oStrip.setVertices(m_vecJointPositions[i]);
                 }
             }
         }
 
-        IMPLEMENT_CAN_HANDLE(".csv")
+        // plain recordings and the compressed ones cKinectCSV::LoadFromFile reads
+        static bool canHandle(const std::string& sFilename)
+        {
+            return EndsWith(sFilename, ".csv") || EndsWith(sFilename, ".csv.gz") || EndsWith(sFilename, ".csv.zz");
+        }
 
         static bool loaderSetOptions(Algorithm::Options& options, std::vector<std::string>& filenames)
         {
             // find the name we will handle
             for (auto it = filenames.begin(); it != filenames.end(); ++it)
             {
-                if (it->substr(it->size()-4, 4) == ".csv")
+                if (canHandle(*it))
                 {
                     options.set<std::string>("Input File", *it);
                     it = filenames.erase(it);
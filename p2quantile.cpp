@@ -0,0 +1,140 @@
+#include "p2quantile.h"
+
+#include <algorithm>
+
+
+cP2Quantile::cP2Quantile(double fQuantile) :
+    m_fQuantile(fQuantile)
+{
+    Reset();
+}
+
+
+void cP2Quantile::Reset()
+{
+    m_nCount = 0;
+    for (int i=0; i<5; ++i)
+    {
+        m_aHeights[i] = 0.0;
+        m_aPositions[i] = i + 1;
+    }
+
+    m_aDesired[0] = 1.0;
+    m_aDesired[1] = 1.0 + 2.0 * m_fQuantile;
+    m_aDesired[2] = 1.0 + 4.0 * m_fQuantile;
+    m_aDesired[3] = 3.0 + 2.0 * m_fQuantile;
+    m_aDesired[4] = 5.0;
+
+    m_aIncrements[0] = 0.0;
+    m_aIncrements[1] = m_fQuantile / 2.0;
+    m_aIncrements[2] = m_fQuantile;
+    m_aIncrements[3] = (1.0 + m_fQuantile) / 2.0;
+    m_aIncrements[4] = 1.0;
+}
+
+
+std::size_t cP2Quantile::Count() const
+{
+    return m_nCount;
+}
+
+
+void cP2Quantile::Add(double fValue)
+{
+    // the first five values become the markers
+    if (m_nCount < 5)
+    {
+        m_aHeights[m_nCount++] = fValue;
+        if (m_nCount == 5)
+        {
+            std::sort(m_aHeights, m_aHeights + 5);
+        }
+        return;
+    }
+    ++m_nCount;
+
+    // cell of the new value, the extreme markers follow minimum and maximum
+    int k;
+    if (fValue < m_aHeights[0])
+    {
+        m_aHeights[0] = fValue;
+        k = 0;
+    }
+    else if (fValue >= m_aHeights[4])
+    {
+        m_aHeights[4] = fValue;
+        k = 3;
+    }
+    else
+    {
+        k = 0;
+        while (fValue >= m_aHeights[k + 1])
+        {
+            ++k;
+        }
+    }
+
+    for (int i=k+1; i<5; ++i)
+    {
+        m_aPositions[i] += 1.0;
+    }
+    for (int i=0; i<5; ++i)
+    {
+        m_aDesired[i] += m_aIncrements[i];
+    }
+
+    // move the middle markers towards their desired positions
+    for (int i=1; i<4; ++i)
+    {
+        double fOffset = m_aDesired[i] - m_aPositions[i];
+        if ((fOffset >= 1.0 && m_aPositions[i + 1] - m_aPositions[i] > 1.0)
+            || (fOffset <= -1.0 && m_aPositions[i - 1] - m_aPositions[i] < -1.0))
+        {
+            int nDirection = (fOffset > 0.0) ? 1 : -1;
+            double fHeight = Parabolic(i, nDirection);
+            if (!(m_aHeights[i - 1] < fHeight && fHeight < m_aHeights[i + 1]))
+            {
+                fHeight = Linear(i, nDirection);
+            }
+            m_aHeights[i] = fHeight;
+            m_aPositions[i] += nDirection;
+        }
+    }
+}
+
+
+double cP2Quantile::Value() const
+{
+    if (m_nCount >= 5)
+    {
+        return m_aHeights[2];
+    }
+    if (m_nCount == 0)
+    {
+        return 0.0;
+    }
+
+    // exact for the first values
+    double aSorted[5];
+    std::copy(m_aHeights, m_aHeights + m_nCount, aSorted);
+    std::sort(aSorted, aSorted + m_nCount);
+    std::size_t nIndex = static_cast<std::size_t>(m_fQuantile * m_nCount);
+    return aSorted[(nIndex < m_nCount) ? nIndex : m_nCount - 1];
+}
+
+
+double cP2Quantile::Parabolic(int i, double fDirection) const
+{
+    const double* q = m_aHeights;
+    const double* n = m_aPositions;
+    return q[i] + fDirection / (n[i + 1] - n[i - 1])
+                * ((n[i] - n[i - 1] + fDirection) * (q[i + 1] - q[i]) / (n[i + 1] - n[i])
+                 + (n[i + 1] - n[i] - fDirection) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+}
+
+
+double cP2Quantile::Linear(int i, int nDirection) const
+{
+    return m_aHeights[i] + nDirection * (m_aHeights[i + nDirection] - m_aHeights[i])
+                                      / (m_aPositions[i + nDirection] - m_aPositions[i]);
+}
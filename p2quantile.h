@@ -0,0 +1,36 @@
+#ifndef CP2QUANTILE_H
+#define CP2QUANTILE_H
+
+#include <cstddef>
+
+
+/* Streaming estimate of a quantile with the P-square algorithm (Jain and
+ * Chlamtac, 1985): five markers are moved along the observations with a
+ * piecewise parabolic fit, so memory and time per value are constant and
+ * no observation has to be kept or sorted. Up to five values the result is
+ * exact. */
+class cP2Quantile
+{
+public:
+  cP2Quantile(double fQuantile = 0.5);
+
+  void Add(double fValue);
+  double Value() const;
+  std::size_t Count() const;
+  void Reset();
+
+private:
+  double m_fQuantile;
+  std::size_t m_nCount;
+
+  // marker heights, actual and desired marker positions, desired increments
+  double m_aHeights[5];
+  double m_aPositions[5];
+  double m_aDesired[5];
+  double m_aIncrements[5];
+
+  double Parabolic(int i, double fDirection) const;
+  double Linear(int i, int nDirection) const;
+};
+
+#endif // CP2QUANTILE_H
@@ -0,0 +1,66 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+
+// number of worker threads to use when the caller passes 0
+inline unsigned HardwareThreads()
+{
+    unsigned nThreads = std::thread::hardware_concurrency();
+    return nThreads ? nThreads : 1;
+}
+
+
+/* Calls oFunction(i) for every i in [nBegin, nEnd). The indices are split into
+ * contiguous blocks, one per thread; the calling thread works on the first
+ * block. nThreads == 0 uses all hardware threads. */
+template<class F>
+void ParallelFor(std::size_t nBegin, std::size_t nEnd, F oFunction, unsigned nThreads = 0)
+{
+    if (nEnd <= nBegin)
+    {
+        return;
+    }
+
+    std::size_t nCount = nEnd - nBegin;
+    std::size_t nBlocks = nThreads ? nThreads : HardwareThreads();
+    nBlocks = (nBlocks < nCount) ? nBlocks : nCount;
+
+    if (nBlocks <= 1)
+    {
+        for (std::size_t i=nBegin; i<nEnd; ++i)
+        {
+            oFunction(i);
+        }
+        return;
+    }
+
+    auto oBlock = [&](std::size_t nBlock)
+    {
+        std::size_t nFirst = nBegin + (nCount * nBlock) / nBlocks;
+        std::size_t nLast = nBegin + (nCount * (nBlock + 1)) / nBlocks;
+        for (std::size_t i=nFirst; i<nLast; ++i)
+        {
+            oFunction(i);
+        }
+    };
+
+    std::vector<std::thread> vecThreads;
+    vecThreads.reserve(nBlocks - 1);
+    for (std::size_t nBlock=1; nBlock<nBlocks; ++nBlock)
+    {
+        vecThreads.push_back(std::thread(oBlock, nBlock));
+    }
+
+    oBlock(0);
+
+    for (auto& oThread : vecThreads)
+    {
+        oThread.join();
+    }
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,169 @@
+#include "skeletonframes.h"
+
+#include <cstring>
+#include <algorithm>
+
+
+const std::size_t cSkeletonFrames::nColumns;
+
+
+cSkeletonFrames::cSkeletonFrames() :
+    m_nSize(0),
+    m_nCapacity(0)
+{
+}
+
+
+void cSkeletonFrames::Reserve(std::size_t nFrames)
+{
+    if (nFrames <= m_nCapacity)
+    {
+        return;
+    }
+
+    // columns are laid out back to back, so a bigger block needs a relayout
+    std::vector<float> vecData(nColumns * nFrames, 0.0f);
+    for (std::size_t nColumn=0; nColumn<nColumns; ++nColumn)
+    {
+        if (m_nSize > 0)
+        {
+            memcpy(&vecData[nColumn * nFrames],
+                   &m_vecData[nColumn * m_nCapacity],
+                   m_nSize * sizeof(float));
+        }
+    }
+
+    m_vecData.swap(vecData);
+    m_vecTime.resize(nFrames, 0);
+    m_nCapacity = nFrames;
+}
+
+
+void cSkeletonFrames::Resize(std::size_t nFrames)
+{
+    Reserve(nFrames);
+    m_nSize = nFrames;
+}
+
+
+void cSkeletonFrames::Clear()
+{
+    m_nSize = 0;
+}
+
+
+std::size_t cSkeletonFrames::Size() const
+{
+    return m_nSize;
+}
+
+
+std::size_t cSkeletonFrames::Capacity() const
+{
+    return m_nCapacity;
+}
+
+
+bool cSkeletonFrames::Empty() const
+{
+    return m_nSize == 0;
+}
+
+
+std::size_t cSkeletonFrames::PushBack(std::int64_t nTime)
+{
+    if (m_nSize == m_nCapacity)
+    {
+        Reserve(m_nCapacity ? m_nCapacity * 2 : 1024);
+    }
+
+    for (std::size_t nColumn=0; nColumn<nColumns; ++nColumn)
+    {
+        Column(nColumn)[m_nSize] = 0.0f;
+    }
+    m_vecTime[m_nSize] = nTime;
+
+    return m_nSize++;
+}
+
+
+void cSkeletonFrames::PopBack()
+{
+    if (m_nSize > 0)
+    {
+        --m_nSize;
+    }
+}
+
+
+void cSkeletonFrames::MoveFrames(std::size_t nFrom, std::size_t nCount, std::size_t nTo)
+{
+    if (nFrom == nTo || nCount == 0)
+    {
+        return;
+    }
+
+    for (std::size_t nColumn=0; nColumn<nColumns; ++nColumn)
+    {
+        memmove(Column(nColumn) + nTo, Column(nColumn) + nFrom, nCount * sizeof(float));
+    }
+    memmove(&m_vecTime[nTo], &m_vecTime[nFrom], nCount * sizeof(std::int64_t));
+}
+
+
+std::int64_t& cSkeletonFrames::Time(std::size_t nFrame)
+{
+    return m_vecTime[nFrame];
+}
+
+
+std::int64_t cSkeletonFrames::Time(std::size_t nFrame) const
+{
+    return m_vecTime[nFrame];
+}
+
+
+const std::int64_t* cSkeletonFrames::TimeColumn() const
+{
+    return m_vecTime.data();
+}
+
+
+float* cSkeletonFrames::Column(eJointType eType, int nAxis)
+{
+    return Column(static_cast<std::size_t>(eType) * 3 + nAxis);
+}
+
+
+const float* cSkeletonFrames::Column(eJointType eType, int nAxis) const
+{
+    return Column(static_cast<std::size_t>(eType) * 3 + nAxis);
+}
+
+
+float* cSkeletonFrames::Column(std::size_t nColumn)
+{
+    return m_vecData.data() + nColumn * m_nCapacity;
+}
+
+
+const float* cSkeletonFrames::Column(std::size_t nColumn) const
+{
+    return m_vecData.data() + nColumn * m_nCapacity;
+}
+
+
+cVector3<float> cSkeletonFrames::GetPosition(eJointType eType, std::size_t nFrame) const
+{
+    return cVector3<float>(Column(eType, 0)[nFrame],
+                           Column(eType, 1)[nFrame],
+                           Column(eType, 2)[nFrame]);
+}
+
+
+void cSkeletonFrames::SetPosition(eJointType eType, std::size_t nFrame, const cVector3<float>& oPosition)
+{
+    Column(eType, 0)[nFrame] = oPosition[0];
+    Column(eType, 1)[nFrame] = oPosition[1];
+    Column(eType, 2)[nFrame] = oPosition[2];
+}
@@ -0,0 +1,59 @@
+#ifndef CSKELETONFRAMES_H
+#define CSKELETONFRAMES_H
+
+#include "joint.h"
+#include "vector3.hpp"
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+
+/* Struct-of-arrays storage for skeleton frames. All positions live in one
+ * block: for every joint and axis a column of Capacity() floats, so the x
+ * values of one joint over all frames are contiguous in memory. */
+class cSkeletonFrames
+{
+public:
+  static const std::size_t nColumns = JT_Count * 3;
+
+  cSkeletonFrames();
+
+  void Reserve(std::size_t nFrames);
+  // does not touch the data, so reserved frames can be filled before they
+  // are made visible by growing the size
+  void Resize(std::size_t nFrames);
+  void Clear();
+
+  std::size_t Size() const;
+  std::size_t Capacity() const;
+  bool Empty() const;
+
+  // appends a frame with all positions set to zero and returns its index
+  std::size_t PushBack(std::int64_t nTime);
+  void PopBack();
+
+  // copies nCount frames starting at nFrom to nTo (ranges may overlap)
+  void MoveFrames(std::size_t nFrom, std::size_t nCount, std::size_t nTo);
+
+  std::int64_t& Time(std::size_t nFrame);
+  std::int64_t Time(std::size_t nFrame) const;
+  const std::int64_t* TimeColumn() const;
+
+  float* Column(eJointType eType, int nAxis);
+  const float* Column(eJointType eType, int nAxis) const;
+  float* Column(std::size_t nColumn);
+  const float* Column(std::size_t nColumn) const;
+
+  cVector3<float> GetPosition(eJointType eType, std::size_t nFrame) const;
+  void SetPosition(eJointType eType, std::size_t nFrame, const cVector3<float>& oPosition);
+
+private:
+  std::size_t m_nSize;
+  std::size_t m_nCapacity;
+
+  std::vector<std::int64_t> m_vecTime;
+  std::vector<float> m_vecData;
+};
+
+#endif // CSKELETONFRAMES_H
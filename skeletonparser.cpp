@@ -0,0 +1,257 @@
+#include "skeletonparser.h"
+#include "mappedfile.h"
+#include "fielddecoder.h"
+#include "parallel.h"
+
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+
+
+cSkeletonCSVParser::cSkeletonCSVParser(char cDelimiter) :
+    m_cDelimiter(cDelimiter)
+{
+}
+
+
+const std::size_t cSkeletonCSVParser::nMinChunkSize;
+
+
+bool cSkeletonCSVParser::LoadFromFile(const std::string& sFilename, cSkeletonFrames& oFrames, unsigned nThreads)
+{
+    cMappedFile oFile;
+    if (!oFile.Open(sFilename))
+    {
+        return false;
+    }
+
+    if (nThreads == 1)
+    {
+        Parse(oFile.Begin(), oFile.End(), oFrames);
+    }
+    else
+    {
+        ParseParallel(oFile.Begin(), oFile.End(), oFrames, nThreads);
+    }
+    return true;
+}
+
+
+void cSkeletonCSVParser::SetJoints(const std::vector<eJointType>& vecJoints)
+{
+    m_oSchema.Project(vecJoints);
+}
+
+
+void cSkeletonCSVParser::SetAllJoints()
+{
+    m_oSchema.ProjectAll();
+}
+
+
+const cSkeletonSchema& cSkeletonCSVParser::Schema() const
+{
+    return m_oSchema;
+}
+
+
+const char* cSkeletonCSVParser::ReadHeader(const char* pBegin, const char* pEnd)
+{
+    bool bAccepted;
+    return ReadHeader(pBegin, pEnd, bAccepted);
+}
+
+
+const char* cSkeletonCSVParser::ReadHeader(const char* pBegin, const char* pEnd, bool& bAccepted)
+{
+    // data rows start with the timestamp, anything else is taken as header
+    bAccepted = true;
+    if (pBegin == pEnd || isdigit(static_cast<unsigned char>(*pBegin)) || *pBegin == '-')
+    {
+        return pBegin;
+    }
+
+    const char* pLineEnd = FindDelimiter(pBegin, pEnd, '\n');
+    const char* pNext = (pLineEnd < pEnd) ? pLineEnd + 1 : pEnd;
+    if (pLineEnd > pBegin && *(pLineEnd - 1) == '\r')
+    {
+        --pLineEnd;
+    }
+
+    bAccepted = m_oSchema.Resolve(pBegin, pLineEnd, m_cDelimiter);
+    return pNext;
+}
+
+
+std::size_t cSkeletonCSVParser::CountLines(const char* pBegin, const char* pEnd)
+{
+    std::size_t nLines = 0;
+    const char* pCur = pBegin;
+    while (pCur < pEnd)
+    {
+        const char* pNewLine = static_cast<const char*>(memchr(pCur, '\n', pEnd - pCur));
+        ++nLines;
+        if (!pNewLine)
+        {
+            break;
+        }
+        pCur = pNewLine + 1;
+    }
+    return nLines;
+}
+
+
+std::size_t cSkeletonCSVParser::Parse(const char* pBegin, const char* pEnd, cSkeletonFrames& oFrames)
+{
+    pBegin = ReadHeader(pBegin, pEnd);
+
+    // one pass to size the block, so the rows below never reallocate
+    std::size_t nFirst = oFrames.Size();
+    oFrames.Reserve(nFirst + CountLines(pBegin, pEnd));
+
+    std::size_t nParsed = ParseRange(pBegin, pEnd, oFrames, nFirst);
+
+    oFrames.Resize(nFirst + nParsed);
+    return nParsed;
+}
+
+
+std::size_t cSkeletonCSVParser::ParseParallel(const char* pBegin, const char* pEnd,
+                                             cSkeletonFrames& oFrames, unsigned nThreads)
+{
+    nThreads = nThreads ? nThreads : HardwareThreads();
+    pBegin = ReadHeader(pBegin, pEnd);
+
+    std::size_t nChunks = static_cast<std::size_t>(pEnd - pBegin) / nMinChunkSize;
+    nChunks = (nChunks < nThreads) ? nChunks : nThreads;
+    if (nChunks <= 1)
+    {
+        return Parse(pBegin, pEnd, oFrames);
+    }
+
+    // split into byte ranges that start right behind a line break
+    std::vector<const char*> vecBounds(nChunks + 1, pEnd);
+    vecBounds[0] = pBegin;
+    for (std::size_t nChunk=1; nChunk<nChunks; ++nChunk)
+    {
+        const char* pSplit = pBegin + (pEnd - pBegin) * nChunk / nChunks;
+        pSplit = (pSplit < vecBounds[nChunk-1]) ? vecBounds[nChunk-1] : pSplit;
+        const char* pNewLine = static_cast<const char*>(memchr(pSplit, '\n', pEnd - pSplit));
+        vecBounds[nChunk] = pNewLine ? pNewLine + 1 : pEnd;
+    }
+
+    // count first, so every chunk knows where its rows start in the block
+    std::vector<std::size_t> vecLines(nChunks, 0);
+    ParallelFor(0, nChunks, [&](std::size_t nChunk)
+    {
+        vecLines[nChunk] = CountLines(vecBounds[nChunk], vecBounds[nChunk+1]);
+    }, nThreads);
+
+    std::size_t nFirst = oFrames.Size();
+    std::vector<std::size_t> vecOffsets(nChunks, nFirst);
+    for (std::size_t nChunk=1; nChunk<nChunks; ++nChunk)
+    {
+        vecOffsets[nChunk] = vecOffsets[nChunk-1] + vecLines[nChunk-1];
+    }
+    oFrames.Reserve(vecOffsets[nChunks-1] + vecLines[nChunks-1]);
+
+    std::vector<std::size_t> vecParsed(nChunks, 0);
+    ParallelFor(0, nChunks, [&](std::size_t nChunk)
+    {
+        vecParsed[nChunk] = ParseRange(vecBounds[nChunk], vecBounds[nChunk+1], oFrames, vecOffsets[nChunk]);
+    }, nThreads);
+
+    // header and empty lines leave holes at the end of a chunk, close them
+    std::size_t nEnd = nFirst + vecParsed[0];
+    for (std::size_t nChunk=1; nChunk<nChunks; ++nChunk)
+    {
+        oFrames.MoveFrames(vecOffsets[nChunk], vecParsed[nChunk], nEnd);
+        nEnd += vecParsed[nChunk];
+    }
+    oFrames.Resize(nEnd);
+    return nEnd - nFirst;
+}
+
+
+std::size_t cSkeletonCSVParser::ParseRange(const char* pBegin, const char* pEnd,
+                                           cSkeletonFrames& oFrames, std::size_t nFirst)
+{
+    std::size_t nFrame = nFirst;
+    const char* pCur = pBegin;
+    while (pCur < pEnd)
+    {
+        const char* pLineEnd = static_cast<const char*>(memchr(pCur, '\n', pEnd - pCur));
+        const char* pNext = pLineEnd ? pLineEnd + 1 : pEnd;
+        if (!pLineEnd)
+        {
+            pLineEnd = pEnd;
+        }
+        if (pLineEnd > pCur && *(pLineEnd - 1) == '\r')
+        {
+            --pLineEnd;
+        }
+
+        if (ParseRow(pCur, pLineEnd, oFrames, nFrame))
+        {
+            ++nFrame;
+        }
+        pCur = pNext;
+    }
+
+    // rows only write the columns of the schema; joints outside of the
+    // projection or missing from the header get defined values, a reused
+    // block would otherwise keep those of an earlier recording
+    bool aWritten[cSkeletonFrames::nColumns] = {};
+    for (auto nColumn : m_oSchema.Columns())
+    {
+        aWritten[nColumn] = true;
+    }
+    for (std::size_t nColumn=0; nColumn<cSkeletonFrames::nColumns; ++nColumn)
+    {
+        if (!aWritten[nColumn])
+        {
+            float* pColumn = oFrames.Column(nColumn);
+            std::fill(pColumn + nFirst, pColumn + nFrame, 0.0f);
+        }
+    }
+
+    return nFrame - nFirst;
+}
+
+
+bool cSkeletonCSVParser::ParseRow(const char* pBegin, const char* pEnd,
+                                  cSkeletonFrames& oFrames, std::size_t nFrame)
+{
+    // empty lines and repeated header rows carry no frame
+    if (pBegin == pEnd || !(isdigit(static_cast<unsigned char>(*pBegin)) || *pBegin == '-'))
+    {
+        return false;
+    }
+
+    // fields missing at the end of a truncated row are stored as zero
+    float aValues[cSkeletonFrames::nColumns] = {};
+    std::int64_t nTime = 0;
+
+    const int* pTargets = m_oSchema.Targets().data();
+    ForEachField(pBegin, pEnd, m_cDelimiter, m_oSchema.FieldCount(),
+                 [&](std::size_t nField, const char* pFieldBegin, const char* pFieldEnd)
+    {
+        int nTarget = pTargets[nField];
+        if (nTarget >= 0)
+        {
+            ParseFloat(pFieldBegin, pFieldEnd, aValues[nTarget]);
+        }
+        else if (nTarget == cSkeletonSchema::nTime)
+        {
+            ParseInt64(pFieldBegin, pFieldEnd, nTime);
+        }
+    });
+
+    oFrames.Time(nFrame) = nTime;
+    for (auto nColumn : m_oSchema.Columns())
+    {
+        oFrames.Column(nColumn)[nFrame] = aValues[nColumn];
+    }
+
+    return true;
+}
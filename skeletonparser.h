@@ -0,0 +1,58 @@
+#ifndef CSKELETONPARSER_H
+#define CSKELETONPARSER_H
+
+#include "skeletonframes.h"
+#include "skeletonschema.h"
+
+#include <string>
+#include <cstddef>
+
+
+/* Bulk parser for the Kinect skeleton recordings
+ * (Time, SpineBase_X, SpineBase_Y, SpineBase_Z, SpineMid_X, ...).
+ * Rows are decoded straight from the file bytes into the columns of a
+ * cSkeletonFrames, values are stored as recorded (no axis flips).
+ * A header row at the start of the parsed data is resolved into the schema
+ * and stays in effect for later calls (e.g. appended rows of a file). */
+class cSkeletonCSVParser
+{
+public:
+  cSkeletonCSVParser(char cDelimiter = '\t');
+
+  // nThreads == 1 parses on the calling thread, 0 uses all cores
+  bool LoadFromFile(const std::string& sFilename, cSkeletonFrames& oFrames, unsigned nThreads = 1);
+
+  // appends all data rows in [pBegin, pEnd) and returns how many were added
+  std::size_t Parse(const char* pBegin, const char* pEnd, cSkeletonFrames& oFrames);
+
+  // like Parse, but newline aligned chunks are parsed concurrently; the
+  // frames keep the order of the file, as with Parse
+  std::size_t ParseParallel(const char* pBegin, const char* pEnd, cSkeletonFrames& oFrames,
+                            unsigned nThreads = 0);
+
+  // reads the header row at pBegin, if the range does not start with a data
+  // row, and returns the position behind it; bAccepted is false if that row
+  // named neither a time nor any joint column and the schema stayed as it was
+  const char* ReadHeader(const char* pBegin, const char* pEnd, bool& bAccepted);
+
+  // only decode these joints, the columns of all others are left at zero
+  void SetJoints(const std::vector<eJointType>& vecJoints);
+  void SetAllJoints();
+  const cSkeletonSchema& Schema() const;
+
+  static std::size_t CountLines(const char* pBegin, const char* pEnd);
+
+private:
+  char m_cDelimiter;
+  cSkeletonSchema m_oSchema;
+
+  // below this size the thread start up costs more than it saves
+  static const std::size_t nMinChunkSize = 1 << 20;
+
+  std::size_t ParseRange(const char* pBegin, const char* pEnd, cSkeletonFrames& oFrames, std::size_t nFirst);
+
+  const char* ReadHeader(const char* pBegin, const char* pEnd);
+  bool ParseRow(const char* pBegin, const char* pEnd, cSkeletonFrames& oFrames, std::size_t nFrame);
+};
+
+#endif // CSKELETONPARSER_H
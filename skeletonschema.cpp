@@ -0,0 +1,161 @@
+#include "skeletonschema.h"
+#include "fielddecoder.h"
+
+#include <cstring>
+
+
+const int cSkeletonSchema::nSkip;
+const int cSkeletonSchema::nTime;
+
+
+cSkeletonSchema::cSkeletonSchema()
+{
+    for (int i=0; i<JT_Count; ++i)
+    {
+        m_aSelected[i] = true;
+    }
+    SetPositional();
+}
+
+
+void cSkeletonSchema::SetPositional()
+{
+    m_vecFields.clear();
+    m_vecFields.push_back(nTime);
+    for (int nColumn=0; nColumn<JT_Count * 3; ++nColumn)
+    {
+        m_vecFields.push_back(nColumn);
+    }
+    Compile();
+}
+
+
+bool cSkeletonSchema::Resolve(const char* pBegin, const char* pEnd, char cDelimiter)
+{
+    std::vector<int> vecFields;
+    bool bAny = false;
+
+    ForEachField(pBegin, pEnd, cDelimiter, static_cast<std::size_t>(-1),
+                 [&](std::size_t, const char* pFieldBegin, const char* pFieldEnd)
+    {
+        int nTarget = nSkip;
+        std::size_t nSize = static_cast<std::size_t>(pFieldEnd - pFieldBegin);
+
+        if (nSize == 4 && strncmp(pFieldBegin, "Time", 4) == 0)
+        {
+            nTarget = nTime;
+        }
+        else if (nSize > 2 && pFieldEnd[-2] == '_')
+        {
+            // <JointName>_<X|Y|Z>
+            eJointType eType;
+            int nAxis = pFieldEnd[-1] - 'X';
+            if (nAxis >= 0 && nAxis < 3 && JointTypeFromName(pFieldBegin, pFieldEnd - 2, eType))
+            {
+                nTarget = static_cast<int>(eType) * 3 + nAxis;
+            }
+        }
+
+        bAny = bAny || (nTarget != nSkip);
+        vecFields.push_back(nTarget);
+    });
+
+    if (!bAny)
+    {
+        return false;
+    }
+
+    m_vecFields.swap(vecFields);
+    Compile();
+    return true;
+}
+
+
+void cSkeletonSchema::Project(const std::vector<eJointType>& vecJoints)
+{
+    for (int i=0; i<JT_Count; ++i)
+    {
+        m_aSelected[i] = false;
+    }
+    for (auto eType : vecJoints)
+    {
+        m_aSelected[eType] = true;
+    }
+    Compile();
+}
+
+
+void cSkeletonSchema::ProjectAll()
+{
+    for (int i=0; i<JT_Count; ++i)
+    {
+        m_aSelected[i] = true;
+    }
+    Compile();
+}
+
+
+bool cSkeletonSchema::IsSelected(eJointType eType) const
+{
+    return m_aSelected[eType];
+}
+
+
+bool cSkeletonSchema::HasJoint(eJointType eType) const
+{
+    for (auto nTarget : m_vecFields)
+    {
+        if (nTarget >= 0 && nTarget / 3 == static_cast<int>(eType))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+std::size_t cSkeletonSchema::FieldCount() const
+{
+    return m_vecTargets.size();
+}
+
+
+const std::vector<int>& cSkeletonSchema::Targets() const
+{
+    return m_vecTargets;
+}
+
+
+const std::vector<std::size_t>& cSkeletonSchema::Columns() const
+{
+    return m_vecColumns;
+}
+
+
+void cSkeletonSchema::Compile()
+{
+    m_vecTargets.clear();
+    m_vecColumns.clear();
+
+    std::size_t nNeeded = 0;
+    for (std::size_t nField=0; nField<m_vecFields.size(); ++nField)
+    {
+        int nTarget = m_vecFields[nField];
+        if (nTarget >= 0 && !m_aSelected[nTarget / 3])
+        {
+            nTarget = nSkip;
+        }
+        if (nTarget >= 0)
+        {
+            m_vecColumns.push_back(static_cast<std::size_t>(nTarget));
+        }
+        if (nTarget != nSkip)
+        {
+            nNeeded = nField + 1;
+        }
+        m_vecTargets.push_back(nTarget);
+    }
+
+    // nothing behind the last needed field has to be scanned
+    m_vecTargets.resize(nNeeded);
+}
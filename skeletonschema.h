@@ -0,0 +1,51 @@
+#ifndef CSKELETONSCHEMA_H
+#define CSKELETONSCHEMA_H
+
+#include "joint.h"
+
+#include <vector>
+#include <cstddef>
+
+
+/* Column layout of a skeleton recording. Resolve compiles the header row
+ * (Time, SpineBase_X, ..., Nec_Y, ...) into a table that maps every field of
+ * a row to a column of cSkeletonFrames. Without a header the recorder's
+ * positional layout is assumed (time first, then x/y/z in eJointType order).
+ * A projection restricts decoding to some joints; fields of the other
+ * joints are skipped without being parsed and the row is only scanned up to
+ * the last field that is needed. */
+class cSkeletonSchema
+{
+public:
+  static const int nSkip = -1;
+  static const int nTime = -2;
+
+  cSkeletonSchema();
+
+  void SetPositional();
+  // returns false if the row names neither a time nor any joint column
+  bool Resolve(const char* pBegin, const char* pEnd, char cDelimiter);
+
+  void Project(const std::vector<eJointType>& vecJoints);
+  void ProjectAll();
+
+  bool IsSelected(eJointType eType) const;
+  bool HasJoint(eJointType eType) const;
+
+  // number of fields that have to be looked at per row
+  std::size_t FieldCount() const;
+  // per field the column of cSkeletonFrames, nTime or nSkip
+  const std::vector<int>& Targets() const;
+  // columns that are written by a row
+  const std::vector<std::size_t>& Columns() const;
+
+private:
+  std::vector<int> m_vecFields;
+  std::vector<int> m_vecTargets;
+  std::vector<std::size_t> m_vecColumns;
+  bool m_aSelected[JT_Count];
+
+  void Compile();
+};
+
+#endif // CSKELETONSCHEMA_H
@@ -0,0 +1,149 @@
+#ifndef SKELETONTOPOLOGY_H
+#define SKELETONTOPOLOGY_H
+
+#include "joint.h"
+
+#include <cstddef>
+
+
+/* Bone structure of the Kinect skeleton, rooted at the spine base.
+ * Every joint except the root ends exactly one bone; the limb length of a
+ * joint is the length of that bone. */
+
+struct sBone
+{
+  eJointType eParent;
+  eJointType eChild;
+};
+
+
+// all bones, ordered by parent joint type, children in the order they branch off
+constexpr sBone aBones[JT_Count - 1] = {
+  {JT_SpineBase, JT_SpineMid},
+  {JT_SpineBase, JT_HipLeft},
+  {JT_SpineBase, JT_HipRight},
+  {JT_SpineMid, JT_SpineShoulder},
+  {JT_Neck, JT_Head},
+  {JT_ShoulderLeft, JT_ElbowLeft},
+  {JT_ElbowLeft, JT_WristLeft},
+  {JT_WristLeft, JT_HandLeft},
+  {JT_HandLeft, JT_ThumbLeft},
+  {JT_HandLeft, JT_HandTipLeft},
+  {JT_ShoulderRight, JT_ElbowRight},
+  {JT_ElbowRight, JT_WristRight},
+  {JT_WristRight, JT_HandRight},
+  {JT_HandRight, JT_ThumbRight},
+  {JT_HandRight, JT_HandTipRight},
+  {JT_HipLeft, JT_KneeLeft},
+  {JT_KneeLeft, JT_AnkleLeft},
+  {JT_AnkleLeft, JT_FootLeft},
+  {JT_HipRight, JT_KneeRight},
+  {JT_KneeRight, JT_AnkleRight},
+  {JT_AnkleRight, JT_FootRight},
+  {JT_SpineShoulder, JT_Neck},
+  {JT_SpineShoulder, JT_ShoulderLeft},
+  {JT_SpineShoulder, JT_ShoulderRight}
+};
+
+
+// the same bones in forward kinematics order: every parent joint is placed by
+// an earlier bone (or is the root) before its children
+constexpr sBone aForwardBones[JT_Count - 1] = {
+  {JT_SpineBase, JT_SpineMid},
+  {JT_SpineBase, JT_HipLeft},
+  {JT_SpineBase, JT_HipRight},
+  {JT_SpineMid, JT_SpineShoulder},
+  {JT_SpineShoulder, JT_Neck},
+  {JT_SpineShoulder, JT_ShoulderLeft},
+  {JT_SpineShoulder, JT_ShoulderRight},
+  {JT_Neck, JT_Head},
+  {JT_ShoulderLeft, JT_ElbowLeft},
+  {JT_ElbowLeft, JT_WristLeft},
+  {JT_WristLeft, JT_HandLeft},
+  {JT_HandLeft, JT_ThumbLeft},
+  {JT_HandLeft, JT_HandTipLeft},
+  {JT_ShoulderRight, JT_ElbowRight},
+  {JT_ElbowRight, JT_WristRight},
+  {JT_WristRight, JT_HandRight},
+  {JT_HandRight, JT_ThumbRight},
+  {JT_HandRight, JT_HandTipRight},
+  {JT_HipLeft, JT_KneeLeft},
+  {JT_KneeLeft, JT_AnkleLeft},
+  {JT_AnkleLeft, JT_FootLeft},
+  {JT_HipRight, JT_KneeRight},
+  {JT_KneeRight, JT_AnkleRight},
+  {JT_AnkleRight, JT_FootRight}
+};
+
+
+// parent per joint type, the root is its own parent
+constexpr eJointType aJointParents[JT_Count] = {
+  JT_SpineBase,     // SpineBase
+  JT_SpineBase,     // SpineMid
+  JT_SpineShoulder, // Neck
+  JT_Neck,          // Head
+  JT_SpineShoulder, // ShoulderLeft
+  JT_ShoulderLeft,  // ElbowLeft
+  JT_ElbowLeft,     // WristLeft
+  JT_WristLeft,     // HandLeft
+  JT_SpineShoulder, // ShoulderRight
+  JT_ShoulderRight, // ElbowRight
+  JT_ElbowRight,    // WristRight
+  JT_WristRight,    // HandRight
+  JT_SpineBase,     // HipLeft
+  JT_HipLeft,       // KneeLeft
+  JT_KneeLeft,      // AnkleLeft
+  JT_AnkleLeft,     // FootLeft
+  JT_SpineBase,     // HipRight
+  JT_HipRight,      // KneeRight
+  JT_KneeRight,     // AnkleRight
+  JT_AnkleRight,    // FootRight
+  JT_SpineMid,      // SpineShoulder
+  JT_HandLeft,      // HandTipLeft
+  JT_HandLeft,      // ThumbLeft
+  JT_HandRight,     // HandTipRight
+  JT_HandRight      // ThumbRight
+};
+
+
+// the sensor tracks the ends of the limbs too unreliably to reject frames for them
+constexpr bool aLimbChecked[JT_Count] = {
+  true,  true,  true,  false, // SpineBase, SpineMid, Neck, Head
+  true,  true,  true,  false, // ShoulderLeft, ElbowLeft, WristLeft, HandLeft
+  true,  true,  true,  false, // ShoulderRight, ElbowRight, WristRight, HandRight
+  true,  true,  true,  false, // HipLeft, KneeLeft, AnkleLeft, FootLeft
+  true,  true,  true,  false, // HipRight, KneeRight, AnkleRight, FootRight
+  true,  false, false, false, // SpineShoulder, HandTipLeft, ThumbLeft, HandTipRight
+  false                       // ThumbRight
+};
+
+
+constexpr bool IsRoot(eJointType eType)
+{
+  return aJointParents[eType] == eType;
+}
+
+
+// the bone tables are kept by hand next to aJointParents; these checks let
+// the build fail when one of them no longer describes the same skeleton
+constexpr bool EndsBone(const sBone* pBones, std::size_t nCount, eJointType eType)
+{
+  return nCount > 0 && (pBones[nCount - 1].eChild == eType || EndsBone(pBones, nCount - 1, eType));
+}
+
+// every bone joins a joint to its parent, no joint ends two bones, and with
+// bForward every parent is the root or ends an earlier bone
+constexpr bool MatchesParents(const sBone* pBones, std::size_t nCount, bool bForward)
+{
+  return nCount == 0
+      || (!IsRoot(pBones[nCount - 1].eChild)
+          && aJointParents[pBones[nCount - 1].eChild] == pBones[nCount - 1].eParent
+          && !EndsBone(pBones, nCount - 1, pBones[nCount - 1].eChild)
+          && (!bForward || IsRoot(pBones[nCount - 1].eParent) || EndsBone(pBones, nCount - 1, pBones[nCount - 1].eParent))
+          && MatchesParents(pBones, nCount - 1, bForward));
+}
+
+static_assert(MatchesParents(aBones, JT_Count - 1, false), "aBones does not match aJointParents");
+static_assert(MatchesParents(aForwardBones, JT_Count - 1, true), "aForwardBones does not match aJointParents or is out of order");
+
+#endif // SKELETONTOPOLOGY_H
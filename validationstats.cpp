@@ -0,0 +1,234 @@
+#include "validationstats.h"
+
+#include <sstream>
+#include <iomanip>
+
+
+namespace
+{
+    // upper edge of the smallest bin with at least fQuantile of the counts below it
+    double HistogramQuantile(const std::size_t* pBins, std::size_t nBins, double fBinWidth, double fQuantile)
+    {
+        std::size_t nCount = 0;
+        for (std::size_t nBin=0; nBin<nBins; ++nBin)
+        {
+            nCount += pBins[nBin];
+        }
+        if (nCount == 0)
+        {
+            return 0.0;
+        }
+
+        double fRank = fQuantile * nCount;
+        std::size_t nBelow = 0;
+        for (std::size_t nBin=0; nBin<nBins; ++nBin)
+        {
+            nBelow += pBins[nBin];
+            if (nBelow > 0 && nBelow >= fRank)
+            {
+                return (nBin + 1) * fBinWidth;
+            }
+        }
+        return nBins * fBinWidth;
+    }
+}
+
+
+const std::size_t cValidationStats::nDeviationBins;
+constexpr double cValidationStats::fBinWidth;
+
+
+cValidationStats::cValidationStats()
+{
+    Reset();
+}
+
+
+void cValidationStats::Reset()
+{
+    m_nCalibration = 0;
+    m_nAccepted = 0;
+    m_nWithoutTime = 0;
+    m_nOutOfOrder = 0;
+    m_nCollapsed = 0;
+    m_nInterpolated = 0;
+    for (int i=0; i<JT_Count; ++i)
+    {
+        m_aLimbMismatches[i] = 0;
+        for (std::size_t nBin=0; nBin<nDeviationBins; ++nBin)
+        {
+            m_aHistograms[i][nBin] = 0;
+        }
+    }
+}
+
+
+void cValidationStats::Merge(const cValidationStats& oOther)
+{
+    m_nCalibration += oOther.m_nCalibration;
+    m_nAccepted += oOther.m_nAccepted;
+    m_nWithoutTime += oOther.m_nWithoutTime;
+    m_nOutOfOrder += oOther.m_nOutOfOrder;
+    m_nCollapsed += oOther.m_nCollapsed;
+    m_nInterpolated += oOther.m_nInterpolated;
+    for (int i=0; i<JT_Count; ++i)
+    {
+        m_aLimbMismatches[i] += oOther.m_aLimbMismatches[i];
+        for (std::size_t nBin=0; nBin<nDeviationBins; ++nBin)
+        {
+            m_aHistograms[i][nBin] += oOther.m_aHistograms[i][nBin];
+        }
+    }
+}
+
+
+void cValidationStats::AddCalibration()
+{
+    ++m_nCalibration;
+}
+
+
+void cValidationStats::AddAccepted(std::size_t nFrames)
+{
+    m_nAccepted += nFrames;
+}
+
+
+void cValidationStats::AddWithoutTime()
+{
+    ++m_nWithoutTime;
+}
+
+
+void cValidationStats::AddOutOfOrder()
+{
+    ++m_nOutOfOrder;
+}
+
+
+void cValidationStats::AddCollapsed()
+{
+    ++m_nCollapsed;
+}
+
+
+void cValidationStats::AddLimbMismatch(eJointType eBone, double fDeviation)
+{
+    ++m_aLimbMismatches[eBone];
+
+    std::size_t nBin = nDeviationBins - 1;
+    if (fDeviation >= 0.0 && fDeviation < nDeviationBins * fBinWidth)
+    {
+        nBin = static_cast<std::size_t>(fDeviation / fBinWidth);
+        nBin = (nBin < nDeviationBins) ? nBin : nDeviationBins - 1;
+    }
+    ++m_aHistograms[eBone][nBin];
+}
+
+
+void cValidationStats::AddInterpolated(std::size_t nFrames)
+{
+    m_nInterpolated += nFrames;
+}
+
+
+std::size_t cValidationStats::Calibration() const
+{
+    return m_nCalibration;
+}
+
+
+std::size_t cValidationStats::Accepted() const
+{
+    return m_nAccepted;
+}
+
+
+std::size_t cValidationStats::Rejected() const
+{
+    std::size_t nRejected = m_nOutOfOrder + m_nCollapsed;
+    for (int i=0; i<JT_Count; ++i)
+    {
+        nRejected += m_aLimbMismatches[i];
+    }
+    return nRejected;
+}
+
+
+std::size_t cValidationStats::WithoutTime() const
+{
+    return m_nWithoutTime;
+}
+
+
+std::size_t cValidationStats::OutOfOrder() const
+{
+    return m_nOutOfOrder;
+}
+
+
+std::size_t cValidationStats::Collapsed() const
+{
+    return m_nCollapsed;
+}
+
+
+std::size_t cValidationStats::Interpolated() const
+{
+    return m_nInterpolated;
+}
+
+
+std::size_t cValidationStats::LimbMismatches(eJointType eBone) const
+{
+    return m_aLimbMismatches[eBone];
+}
+
+
+const std::size_t* cValidationStats::DeviationHistogram(eJointType eBone) const
+{
+    return m_aHistograms[eBone];
+}
+
+
+double cValidationStats::DeviationQuantile(eJointType eBone, double fQuantile) const
+{
+    return HistogramQuantile(m_aHistograms[eBone], nDeviationBins, fBinWidth, fQuantile);
+}
+
+
+double cValidationStats::DeviationQuantile(double fQuantile) const
+{
+    std::size_t aTotal[nDeviationBins] = {};
+    for (int i=0; i<JT_Count; ++i)
+    {
+        for (std::size_t nBin=0; nBin<nDeviationBins; ++nBin)
+        {
+            aTotal[nBin] += m_aHistograms[i][nBin];
+        }
+    }
+    return HistogramQuantile(aTotal, nDeviationBins, fBinWidth, fQuantile);
+}
+
+
+std::string cValidationStats::Summary() const
+{
+    std::ostringstream oStream;
+    oStream << m_nAccepted << " accepted, " << Rejected() << " rejected ("
+            << m_nCollapsed << " collapsed, " << m_nOutOfOrder << " out of order), "
+            << m_nCalibration << " calibration, " << m_nWithoutTime << " without time, "
+            << m_nInterpolated << " interpolated";
+
+    for (int i=0; i<JT_Count; ++i)
+    {
+        if (m_aLimbMismatches[i] == 0)
+        {
+            continue;
+        }
+
+        oStream << "\n  " << JointTypeName(static_cast<eJointType>(i)) << ": " << m_aLimbMismatches[i]
+                << " rejected, median deviation < " << std::fixed << std::setprecision(0)
+                << DeviationQuantile(static_cast<eJointType>(i), 0.5) * 100.0 << " %";
+    }
+    return oStream.str();
+}
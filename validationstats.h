@@ -0,0 +1,66 @@
+#ifndef CVALIDATIONSTATS_H
+#define CVALIDATIONSTATS_H
+
+#include "joint.h"
+
+#include <string>
+#include <cstddef>
+
+
+/* What happened to the frames offered to a motion: how many calibrated it,
+ * were accepted, skipped or interpolated, and why the others were rejected. A frame that
+ * fails several bones counts for the first failing one in aBones order; the
+ * relative deviation of that bone, |l - L| / ((l + L) / 2) as checked by
+ * EQPercentageDiff, goes into a histogram per bone. */
+class cValidationStats
+{
+public:
+  // the deviation is at most 2 for positive lengths, the last bin also takes NaN
+  static const std::size_t nDeviationBins = 20;
+  static constexpr double fBinWidth = 0.1;
+
+  cValidationStats();
+  void Reset();
+  void Merge(const cValidationStats& oOther);
+
+  void AddCalibration();
+  void AddAccepted(std::size_t nFrames = 1);
+  void AddWithoutTime();
+  void AddOutOfOrder();
+  void AddCollapsed();
+  void AddLimbMismatch(eJointType eBone, double fDeviation);
+  void AddInterpolated(std::size_t nFrames);
+
+  std::size_t Calibration() const;
+  std::size_t Accepted() const;
+  std::size_t Rejected() const;
+  // frames without timestamp are not validated at all
+  std::size_t WithoutTime() const;
+  std::size_t OutOfOrder() const;
+  std::size_t Collapsed() const;
+  // frames inserted to close short gaps, they are not counted as accepted
+  std::size_t Interpolated() const;
+  // rejected frames whose first failing bone ends in eBone
+  std::size_t LimbMismatches(eJointType eBone) const;
+  // bin i counts the deviations in [i, i + 1) * fBinWidth
+  const std::size_t* DeviationHistogram(eJointType eBone) const;
+  // upper edge of the bin that holds the given quantile of the deviations
+  // of one bone or of all limb mismatches
+  double DeviationQuantile(eJointType eBone, double fQuantile) const;
+  double DeviationQuantile(double fQuantile) const;
+
+  // one line per failing bone, for logs
+  std::string Summary() const;
+
+private:
+  std::size_t m_nCalibration;
+  std::size_t m_nAccepted;
+  std::size_t m_nWithoutTime;
+  std::size_t m_nOutOfOrder;
+  std::size_t m_nCollapsed;
+  std::size_t m_nInterpolated;
+  std::size_t m_aLimbMismatches[JT_Count];
+  std::size_t m_aHistograms[JT_Count][nDeviationBins];
+};
+
+#endif // CVALIDATIONSTATS_H